@@ -0,0 +1,481 @@
+#include "BigRsa.h"
+#include "../helpers/Utils.h"
+#include <openssl/bn.h>
+#include <openssl/rand.h>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+    struct BignumDeleter
+    {
+        void operator()(BIGNUM *number) const { BN_clear_free(number); }
+    };
+    struct BignumContextDeleter
+    {
+        void operator()(BN_CTX *context) const { BN_CTX_free(context); }
+    };
+    struct MontgomeryContextDeleter
+    {
+        void operator()(BN_MONT_CTX *context) const { BN_MONT_CTX_free(context); }
+    };
+    using Bignum = std::unique_ptr<BIGNUM, BignumDeleter>;
+    using BignumContext = std::unique_ptr<BN_CTX, BignumContextDeleter>;
+    using MontgomeryContext = std::unique_ptr<BN_MONT_CTX, MontgomeryContextDeleter>;
+
+    Bignum newBignum()
+    {
+        Bignum number(BN_new());
+        if (!number)
+        {
+            throw std::runtime_error("❌ Error: Could not allocate a big number");
+        }
+        return number;
+    }
+
+    Bignum bignumFromBytes(const std::vector<uint8_t> &bytes)
+    {
+        Bignum number(BN_bin2bn(bytes.data(), static_cast<int>(bytes.size()), nullptr));
+        if (!number)
+        {
+            throw std::runtime_error("❌ Error: Could not allocate a big number");
+        }
+        return number;
+    }
+
+    std::vector<uint8_t> bignumToBytes(const BIGNUM *number)
+    {
+        std::vector<uint8_t> bytes(BN_num_bytes(number));
+        BN_bn2bin(number, bytes.data());
+        return bytes;
+    }
+
+    bool randomNonzeroBytes(uint8_t *bytes, size_t size)
+    {
+        /**
+         * Function to fill a buffer with random bytes that are all different from zero
+         *
+         * @param bytes: The buffer
+         * @param size: The number of bytes to fill
+         *
+         * @return: False if the random generator failed
+         */
+        if (RAND_bytes(bytes, static_cast<int>(size)) != 1)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < size; i++)
+        {
+            while (bytes[i] == 0)
+            {
+                if (RAND_bytes(&bytes[i], 1) != 1)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Private key schedule for decryption through the Chinese remainder theorem: two
+    // exponentiations with half-size moduli and exponents instead of one with the full ones
+    struct CrtKey
+    {
+        Bignum p, q, dP, dQ, qInv;
+        MontgomeryContext montgomeryP, montgomeryQ;
+    };
+
+    bool crtExponentiate(BIGNUM *message, const BIGNUM *cipher, const CrtKey &key, BN_CTX *context)
+    {
+        /**
+         * Function to compute cipher^d mod n from the residues modulo p and q (Garner's formula)
+         *
+         * @param message: Where the result is stored
+         * @param cipher: The ciphertext block, below n
+         * @param key: The CRT key schedule
+         * @param context: A big number context of the calling thread
+         *
+         * @return: False if an operation failed
+         */
+        BN_CTX_start(context);
+        BIGNUM *m1 = BN_CTX_get(context);
+        BIGNUM *m2 = BN_CTX_get(context);
+        BIGNUM *residue = BN_CTX_get(context);
+        bool ok = residue != nullptr &&
+                  BN_mod(residue, cipher, key.p.get(), context) == 1 &&
+                  BN_mod_exp_mont_consttime(m1, residue, key.dP.get(), key.p.get(), context, key.montgomeryP.get()) == 1 &&
+                  BN_mod(residue, cipher, key.q.get(), context) == 1 &&
+                  BN_mod_exp_mont_consttime(m2, residue, key.dQ.get(), key.q.get(), context, key.montgomeryQ.get()) == 1 &&
+                  // m = m2 + q * (qInv * (m1 - m2) mod p)
+                  BN_mod_sub(m1, m1, m2, key.p.get(), context) == 1 &&
+                  BN_mod_mul(m1, m1, key.qInv.get(), key.p.get(), context) == 1 &&
+                  BN_mul(message, m1, key.q.get(), context) == 1 &&
+                  BN_add(message, message, m2) == 1;
+        BN_CTX_end(context);
+        return ok;
+    }
+}
+
+BigRsa::BigRsa(unsigned bits) : bits(bits)
+{
+    /**
+     * Constructor for the BigRsa class
+     *
+     * @param bits: The size of the modulus in bits (a multiple of 16, at least 1024)
+     *
+     * @return: None
+     */
+    if (bits < 1024 || bits % 16 != 0)
+    {
+        throw std::invalid_argument("❌ Error: RSA modulus size must be a multiple of 16 bits and at least 1024 bits");
+    }
+}
+
+bool BigRsa::isSupportedSize(unsigned bits)
+{
+    /**
+     * Function to check whether a modulus size is offered to users
+     *
+     * @param bits: The size of the modulus in bits
+     *
+     * @return: True for 2048, 3072 and 4096 bits
+     */
+    return bits == 2048 || bits == 3072 || bits == 4096;
+}
+
+std::vector<uint8_t> BigRsa::serializeBignums(const std::vector<std::vector<uint8_t>> &numbers)
+{
+    /**
+     * Function to serialize big-endian numbers, each one after its 4-byte big-endian length
+     *
+     * @param numbers: The numbers as big-endian bytes
+     *
+     * @return: The serialized bytes
+     */
+    std::vector<uint8_t> serialized;
+    for (const std::vector<uint8_t> &number : numbers)
+    {
+        uint32_t length = static_cast<uint32_t>(number.size());
+        serialized.push_back(static_cast<uint8_t>(length >> 24));
+        serialized.push_back(static_cast<uint8_t>(length >> 16));
+        serialized.push_back(static_cast<uint8_t>(length >> 8));
+        serialized.push_back(static_cast<uint8_t>(length));
+        serialized.insert(serialized.end(), number.begin(), number.end());
+    }
+    return serialized;
+}
+
+std::vector<std::vector<uint8_t>> BigRsa::deserializeBignums(const std::string &key)
+{
+    /**
+     * Function to read back the numbers of a key
+     *
+     * @param key: The key in base64 format
+     *
+     * @return: The numbers as big-endian bytes
+     */
+    std::vector<uint8_t> serialized = Utils::base64ToBinary(key);
+    std::vector<std::vector<uint8_t>> numbers;
+    size_t position = 0;
+    while (position < serialized.size())
+    {
+        if (serialized.size() - position < 4)
+        {
+            throw std::invalid_argument("❌ Error: Invalid key format");
+        }
+        uint32_t length = (static_cast<uint32_t>(serialized[position]) << 24) |
+                          (static_cast<uint32_t>(serialized[position + 1]) << 16) |
+                          (static_cast<uint32_t>(serialized[position + 2]) << 8) |
+                          static_cast<uint32_t>(serialized[position + 3]);
+        position += 4;
+        if (length == 0 || serialized.size() - position < length)
+        {
+            throw std::invalid_argument("❌ Error: Invalid key format");
+        }
+        numbers.emplace_back(serialized.begin() + position, serialized.begin() + position + length);
+        position += length;
+    }
+    return numbers;
+}
+
+BigRsaKeys BigRsa::generateKeys()
+{
+    /**
+     * Function to generate a key pair with two random primes of bits / 2 bits each
+     *
+     * @return: A struct containing the public and private keys
+     */
+    BignumContext context(BN_CTX_new());
+    if (!context)
+    {
+        throw std::runtime_error("❌ Error: Could not allocate a big number context");
+    }
+    Bignum p = newBignum(), q = newBignum(), n = newBignum(), e = newBignum(), d = newBignum();
+    Bignum pMinusOne = newBignum(), qMinusOne = newBignum(), phi = newBignum(), gcd = newBignum();
+    Bignum dP = newBignum(), dQ = newBignum(), qInv = newBignum();
+    BN_set_word(e.get(), PUBLIC_EXPONENT);
+
+    while (true)
+    {
+        if (BN_generate_prime_ex(p.get(), bits / 2, 0, nullptr, nullptr, nullptr) != 1 ||
+            BN_generate_prime_ex(q.get(), bits / 2, 0, nullptr, nullptr, nullptr) != 1)
+        {
+            throw std::runtime_error("❌ Error: Could not generate the RSA primes");
+        }
+        if (BN_cmp(p.get(), q.get()) == 0)
+        {
+            continue;
+        }
+        BN_mul(n.get(), p.get(), q.get(), context.get());
+        BN_sub(pMinusOne.get(), p.get(), BN_value_one());
+        BN_sub(qMinusOne.get(), q.get(), BN_value_one());
+        BN_mul(phi.get(), pMinusOne.get(), qMinusOne.get(), context.get());
+
+        // e is fixed, so primes where e divides p - 1 or q - 1 are drawn again
+        BN_gcd(gcd.get(), e.get(), phi.get(), context.get());
+        if (BN_num_bits(n.get()) == static_cast<int>(bits) && BN_is_one(gcd.get()) &&
+            BN_mod_inverse(d.get(), e.get(), phi.get(), context.get()) != nullptr)
+        {
+            break;
+        }
+    }
+    if (BN_mod(dP.get(), d.get(), pMinusOne.get(), context.get()) != 1 ||
+        BN_mod(dQ.get(), d.get(), qMinusOne.get(), context.get()) != 1 ||
+        BN_mod_inverse(qInv.get(), q.get(), p.get(), context.get()) == nullptr)
+    {
+        throw std::runtime_error("❌ Error: Could not compute the CRT key schedule");
+    }
+
+    BigRsaKeys result;
+    result.publicKey = Utils::binaryToBase64(serializeBignums({bignumToBytes(e.get()), bignumToBytes(n.get())}));
+    result.privateKey = Utils::binaryToBase64(serializeBignums({bignumToBytes(d.get()), bignumToBytes(n.get()), bignumToBytes(p.get()),
+                                                                bignumToBytes(q.get()), bignumToBytes(dP.get()), bignumToBytes(dQ.get()),
+                                                                bignumToBytes(qInv.get())}));
+    return result;
+}
+
+std::vector<uint8_t> BigRsa::encrypt(const std::vector<uint8_t> &data, const std::string &publicKeyStr)
+{
+    /**
+     * Function to encrypt the data in padded blocks of the modulus size
+     *
+     * @param data: The data to be encrypted
+     * @param publicKeyStr: The public key in string format
+     *
+     * @return: The encrypted data, k bytes per block of at most k - 11 input bytes
+     */
+    if (publicKeyStr.empty())
+    {
+        throw std::invalid_argument("❌ Error: No public key provided");
+    }
+    std::vector<std::vector<uint8_t>> keyValues = deserializeBignums(publicKeyStr);
+    if (keyValues.size() != 2)
+    {
+        throw std::invalid_argument("❌ Error: Invalid public key format");
+    }
+    Bignum e = bignumFromBytes(keyValues[0]);
+    Bignum n = bignumFromBytes(keyValues[1]);
+    const size_t blockBytes = BN_num_bytes(n.get());
+    if (BN_num_bits(n.get()) < 1024 || !BN_is_odd(n.get()))
+    {
+        throw std::invalid_argument("❌ Error: Invalid public key modulus");
+    }
+    const size_t payloadBytes = blockBytes - PADDING_BYTES;
+    const size_t blocks = (data.size() + payloadBytes - 1) / payloadBytes;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    BignumContext setupContext(BN_CTX_new());
+    MontgomeryContext montgomery(BN_MONT_CTX_new());
+    if (!setupContext || !montgomery || BN_MONT_CTX_set(montgomery.get(), n.get(), setupContext.get()) != 1)
+    {
+        throw std::runtime_error("❌ Error: Could not prepare the modulus");
+    }
+
+    std::vector<uint8_t> encryptedValues(blocks * blockBytes);
+    bool failed = false;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        BignumContext context(BN_CTX_new());
+        Bignum message(BN_new()), cipher(BN_new());
+        std::vector<uint8_t> block(blockBytes);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (size_t b = 0; b < blocks; b++)
+        {
+#ifdef _OPENMP
+            if (b == 0)
+            {
+                printf("\033[1;36m🔵 [OpenMP (BigRSA)] Threads used for encryption: %d\033[0m\n", omp_get_num_threads());
+            }
+#endif
+            size_t offset = b * payloadBytes;
+            size_t length = std::min(payloadBytes, data.size() - offset);
+            size_t paddingLength = blockBytes - 3 - length;  // At least 8
+            block[0] = 0x00;
+            block[1] = 0x02;
+            bool ok = context && message && cipher && randomNonzeroBytes(&block[2], paddingLength);
+            block[2 + paddingLength] = 0x00;
+            std::memcpy(&block[3 + paddingLength], &data[offset], length);
+            ok = ok && BN_bin2bn(block.data(), static_cast<int>(blockBytes), message.get()) != nullptr &&
+                 BN_mod_exp_mont(cipher.get(), message.get(), e.get(), n.get(), context.get(), montgomery.get()) == 1 &&
+                 BN_bn2binpad(cipher.get(), &encryptedValues[b * blockBytes], static_cast<int>(blockBytes)) >= 0;
+            if (!ok)
+            {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+                failed = true;
+            }
+        }
+    }
+    if (failed)
+    {
+        throw std::runtime_error("❌ Error: RSA block encryption failed");
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] Encryption time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+    return encryptedValues;
+}
+
+std::vector<uint8_t> BigRsa::decrypt(const std::vector<uint8_t> &data, const std::string &privateKeyStr)
+{
+    /**
+     * Function to decrypt the blocks of the data and remove their padding
+     *
+     * @param data: The encrypted data to be decrypted
+     * @param privateKeyStr: The private key in string format
+     *
+     * @return: The decrypted data
+     */
+    if (privateKeyStr.empty())
+    {
+        throw std::invalid_argument("❌ Error: No private key provided");
+    }
+    std::vector<std::vector<uint8_t>> keyValues = deserializeBignums(privateKeyStr);
+    const bool crt = keyValues.size() == 7;  // Keys with only {d, n} are decrypted without CRT
+    if (keyValues.size() != 2 && !crt)
+    {
+        throw std::invalid_argument("❌ Error: Invalid private key format");
+    }
+    Bignum d = bignumFromBytes(keyValues[0]);
+    Bignum n = bignumFromBytes(keyValues[1]);
+    BN_set_flags(d.get(), BN_FLG_CONSTTIME);
+    CrtKey crtKey;
+    if (crt)
+    {
+        crtKey.p = bignumFromBytes(keyValues[2]);
+        crtKey.q = bignumFromBytes(keyValues[3]);
+        crtKey.dP = bignumFromBytes(keyValues[4]);
+        crtKey.dQ = bignumFromBytes(keyValues[5]);
+        crtKey.qInv = bignumFromBytes(keyValues[6]);
+        for (BIGNUM *secret : {crtKey.p.get(), crtKey.q.get(), crtKey.dP.get(), crtKey.dQ.get(), crtKey.qInv.get()})
+        {
+            BN_set_flags(secret, BN_FLG_CONSTTIME);
+        }
+    }
+    const size_t blockBytes = BN_num_bytes(n.get());
+    if (BN_num_bits(n.get()) < 1024 || !BN_is_odd(n.get()))
+    {
+        throw std::invalid_argument("❌ Error: Invalid private key modulus");
+    }
+    if (data.size() % blockBytes != 0)
+    {
+        throw std::invalid_argument("❌ Error: Invalid encrypted data length (must be a multiple of the block size)");
+    }
+    const size_t blocks = data.size() / blockBytes;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    BignumContext setupContext(BN_CTX_new());
+    MontgomeryContext montgomery(BN_MONT_CTX_new());
+    if (!setupContext || !montgomery || BN_MONT_CTX_set(montgomery.get(), n.get(), setupContext.get()) != 1)
+    {
+        throw std::runtime_error("❌ Error: Could not prepare the modulus");
+    }
+    if (crt)
+    {
+        crtKey.montgomeryP.reset(BN_MONT_CTX_new());
+        crtKey.montgomeryQ.reset(BN_MONT_CTX_new());
+        if (!crtKey.montgomeryP || !crtKey.montgomeryQ ||
+            BN_MONT_CTX_set(crtKey.montgomeryP.get(), crtKey.p.get(), setupContext.get()) != 1 ||
+            BN_MONT_CTX_set(crtKey.montgomeryQ.get(), crtKey.q.get(), setupContext.get()) != 1)
+        {
+            throw std::runtime_error("❌ Error: Could not prepare the prime moduli");
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> decryptedBlocks(blocks);
+    bool failed = false;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+        BignumContext context(BN_CTX_new());
+        Bignum cipher(BN_new()), message(BN_new());
+        std::vector<uint8_t> block(blockBytes);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (size_t b = 0; b < blocks; b++)
+        {
+#ifdef _OPENMP
+            if (b == 0)
+            {
+                printf("\033[1;36m🔵 [OpenMP (BigRSA)] Threads used for decryption: %d\033[0m\n", omp_get_num_threads());
+            }
+#endif
+            bool ok = context && cipher && message &&
+                      BN_bin2bn(&data[b * blockBytes], static_cast<int>(blockBytes), cipher.get()) != nullptr &&
+                      BN_cmp(cipher.get(), n.get()) < 0 &&
+                      (crt ? crtExponentiate(message.get(), cipher.get(), crtKey, context.get())
+                           : BN_mod_exp_mont_consttime(message.get(), cipher.get(), d.get(), n.get(), context.get(), montgomery.get()) == 1) &&
+                      BN_bn2binpad(message.get(), block.data(), static_cast<int>(blockBytes)) >= 0;
+
+            // Padding is 0x00 0x02, at least 8 nonzero bytes and a 0x00 separator
+            size_t separator = 2;
+            while (ok && separator < blockBytes && block[separator] != 0)
+            {
+                separator++;
+            }
+            ok = ok && block[0] == 0x00 && block[1] == 0x02 && separator < blockBytes && separator >= PADDING_BYTES - 1;
+            if (ok)
+            {
+                decryptedBlocks[b].assign(block.begin() + separator + 1, block.end());
+            }
+            else
+            {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+                failed = true;
+            }
+        }
+    }
+    if (failed)
+    {
+        throw std::invalid_argument("❌ Error: Invalid RSA block (wrong key or corrupted data)");
+    }
+
+    size_t totalSize = 0;
+    for (const std::vector<uint8_t> &block : decryptedBlocks)
+    {
+        totalSize += block.size();
+    }
+    std::vector<uint8_t> decryptedValues;
+    decryptedValues.reserve(totalSize);
+    for (const std::vector<uint8_t> &block : decryptedBlocks)
+    {
+        decryptedValues.insert(decryptedValues.end(), block.begin(), block.end());
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] Decryption time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+    return decryptedValues;
+}
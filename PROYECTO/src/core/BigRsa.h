@@ -0,0 +1,41 @@
+#ifndef BIG_RSA_H
+#define BIG_RSA_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// RSA over multi-precision moduli (2048, 3072 or 4096 bits) with OpenSSL BIGNUMs as the limb
+// arithmetic. The input is cut into blocks of k - 11 bytes (k the modulus size in bytes), every
+// block gets PKCS#1 v1.5 type 2 padding and one exponentiation, and its ciphertext is stored in
+// exactly k bytes. Expansion is 11 bytes per block, about 4% for a 2048-bit key.
+//
+// Keys are base64 strings of length-prefixed big-endian numbers: {e, n} for the public key and
+// {d, n, p, q, dP, dQ, qInv} for the private key, which decrypts through the Chinese remainder
+// theorem (a private key with only {d, n} is still accepted and decrypts without it).
+struct BigRsaKeys
+{
+    std::string publicKey;
+    std::string privateKey;
+};
+
+class BigRsa
+{
+private:
+    unsigned bits;
+
+    static std::vector<uint8_t> serializeBignums(const std::vector<std::vector<uint8_t>> &numbers);
+    static std::vector<std::vector<uint8_t>> deserializeBignums(const std::string &key);
+public:
+    static constexpr size_t PADDING_BYTES = 11;  // 0x00 0x02, at least 8 nonzero random bytes, 0x00
+    static constexpr unsigned PUBLIC_EXPONENT = 65537;
+
+    explicit BigRsa(unsigned bits);
+    BigRsaKeys generateKeys();
+    static bool isSupportedSize(unsigned bits);
+    static std::vector<uint8_t> encrypt(const std::vector<uint8_t> &data, const std::string &publicKey);
+    static std::vector<uint8_t> decrypt(const std::vector<uint8_t> &data, const std::string &privateKey);
+};
+
+#endif
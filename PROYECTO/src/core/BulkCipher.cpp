@@ -0,0 +1,258 @@
+#include "BulkCipher.h"
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <memory>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+    struct CipherContextDeleter
+    {
+        void operator()(EVP_CIPHER_CTX *context) const { EVP_CIPHER_CTX_free(context); }
+    };
+    using CipherContext = std::unique_ptr<EVP_CIPHER_CTX, CipherContextDeleter>;
+
+    const EVP_CIPHER *cipherOf(const std::string &name)
+    {
+        return name == "aes-256-gcm" ? EVP_aes_256_gcm() : EVP_chacha20_poly1305();
+    }
+
+    void chunkNonce(uint32_t streamId, uint64_t index, uint8_t *nonce)
+    {
+        /**
+         * Function to build the nonce of a chunk: its stream id and its index, big-endian
+         *
+         * @param streamId: The id of the stream the chunk belongs to
+         * @param index: The position of the chunk in its stream
+         * @param nonce: Where the 12 nonce bytes are written
+         *
+         * @return: None
+         */
+        for (int i = 0; i < 4; i++)
+        {
+            nonce[i] = static_cast<uint8_t>(streamId >> (24 - 8 * i));
+        }
+        for (int i = 0; i < 8; i++)
+        {
+            nonce[4 + i] = static_cast<uint8_t>(index >> (56 - 8 * i));
+        }
+    }
+}
+
+BulkCipher::BulkCipher(const std::string &name) : name(name)
+{
+    /**
+     * Constructor for the BulkCipher class
+     *
+     * @param name: The cipher, 'aes-256-gcm' or 'chacha20-poly1305'
+     *
+     * @return: None
+     */
+    if (!isSupported(name))
+    {
+        throw std::invalid_argument("❌ Error: Unknown bulk cipher '" + name + "'");
+    }
+}
+
+bool BulkCipher::isSupported(const std::string &name)
+{
+    /**
+     * Function to check whether a bulk cipher name is known
+     *
+     * @param name: The cipher name
+     *
+     * @return: True for 'aes-256-gcm' and 'chacha20-poly1305'
+     */
+    return name == "aes-256-gcm" || name == "chacha20-poly1305";
+}
+
+std::vector<uint8_t> BulkCipher::generateKey()
+{
+    /**
+     * Function to draw a random session key
+     *
+     * @return: KEY_BYTES random bytes
+     */
+    std::vector<uint8_t> key(KEY_BYTES);
+    if (RAND_bytes(key.data(), static_cast<int>(key.size())) != 1)
+    {
+        throw std::runtime_error("❌ Error: Could not generate the session key");
+    }
+    return key;
+}
+
+bool BulkCipher::encryptChunk(const uint8_t *in, size_t size, const uint8_t *key, uint32_t streamId, uint64_t index, bool last, uint8_t *out) const
+{
+    /**
+     * Function to seal one chunk
+     *
+     * @param in: The plaintext of the chunk
+     * @param size: The size of the chunk (at most CHUNK_SIZE)
+     * @param key: The KEY_BYTES session key
+     * @param streamId: The id of the stream the chunk belongs to
+     * @param index: The position of the chunk in its stream
+     * @param last: Whether this is the last chunk of its stream
+     * @param out: Where the size ciphertext bytes and the TAG_BYTES tag are written
+     *
+     * @return: False if OpenSSL failed
+     */
+    CipherContext context(EVP_CIPHER_CTX_new());
+    uint8_t nonce[NONCE_BYTES];
+    chunkNonce(streamId, index, nonce);
+    const uint8_t lastFlag = last ? 1 : 0;  // Associated data
+    uint8_t final[16];
+    int length = 0;
+    return context &&
+           EVP_EncryptInit_ex(context.get(), cipherOf(name), nullptr, nullptr, nullptr) == 1 &&
+           EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_AEAD_SET_IVLEN, NONCE_BYTES, nullptr) == 1 &&
+           EVP_EncryptInit_ex(context.get(), nullptr, nullptr, key, nonce) == 1 &&
+           EVP_EncryptUpdate(context.get(), nullptr, &length, &lastFlag, 1) == 1 &&
+           (size == 0 || EVP_EncryptUpdate(context.get(), out, &length, in, static_cast<int>(size)) == 1) &&
+           EVP_EncryptFinal_ex(context.get(), final, &length) == 1 &&
+           EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_AEAD_GET_TAG, TAG_BYTES, out + size) == 1;
+}
+
+bool BulkCipher::decryptChunk(const uint8_t *in, size_t size, const uint8_t *key, uint32_t streamId, uint64_t index, bool last, uint8_t *out) const
+{
+    /**
+     * Function to open one chunk and check its tag
+     *
+     * @param in: The ciphertext of the chunk followed by its tag
+     * @param size: The size of the ciphertext, without the tag
+     * @param key: The KEY_BYTES session key
+     * @param streamId: The id of the stream the chunk belongs to
+     * @param index: The position of the chunk in its stream
+     * @param last: Whether this is the last chunk of its stream
+     * @param out: Where the size plaintext bytes are written
+     *
+     * @return: False if the tag does not match (wrong key, corrupted, reordered or truncated data)
+     */
+    CipherContext context(EVP_CIPHER_CTX_new());
+    uint8_t nonce[NONCE_BYTES];
+    chunkNonce(streamId, index, nonce);
+    const uint8_t lastFlag = last ? 1 : 0;
+    uint8_t tag[TAG_BYTES];
+    std::copy(in + size, in + size + TAG_BYTES, tag);
+    uint8_t final[16];
+    int length = 0;
+    return context &&
+           EVP_DecryptInit_ex(context.get(), cipherOf(name), nullptr, nullptr, nullptr) == 1 &&
+           EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_AEAD_SET_IVLEN, NONCE_BYTES, nullptr) == 1 &&
+           EVP_DecryptInit_ex(context.get(), nullptr, nullptr, key, nonce) == 1 &&
+           EVP_DecryptUpdate(context.get(), nullptr, &length, &lastFlag, 1) == 1 &&
+           (size == 0 || EVP_DecryptUpdate(context.get(), out, &length, in, static_cast<int>(size)) == 1) &&
+           EVP_CIPHER_CTX_ctrl(context.get(), EVP_CTRL_AEAD_SET_TAG, TAG_BYTES, tag) == 1 &&
+           EVP_DecryptFinal_ex(context.get(), final, &length) > 0;
+}
+
+std::vector<uint8_t> BulkCipher::encrypt(const std::vector<uint8_t> &data, const std::vector<uint8_t> &key, uint32_t streamId) const
+{
+    /**
+     * Function to encrypt data as a stream of sealed chunks
+     *
+     * @param data: The data to be encrypted
+     * @param key: The KEY_BYTES session key
+     * @param streamId: An id no other stream encrypted with the same key uses
+     *
+     * @return: The chunks, each one followed by its tag (an empty input still gives one tag)
+     */
+    if (key.size() != KEY_BYTES)
+    {
+        throw std::invalid_argument("❌ Error: Invalid session key size");
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    const size_t chunks = std::max<size_t>(1, (data.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    std::vector<uint8_t> encryptedValues(data.size() + chunks * TAG_BYTES);
+    bool failed = false;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+    {
+#ifdef _OPENMP
+        if (chunk == 0)
+        {
+            printf("\033[1;36m🔵 [OpenMP (%s)] Threads used for encryption: %d\033[0m\n", name.c_str(), omp_get_num_threads());
+        }
+#endif
+        size_t offset = chunk * CHUNK_SIZE;
+        size_t size = std::min(CHUNK_SIZE, data.size() - offset);
+        if (!encryptChunk(data.data() + offset, size, key.data(), streamId, chunk, chunk + 1 == chunks,
+                          encryptedValues.data() + chunk * (CHUNK_SIZE + TAG_BYTES)))
+        {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+            failed = true;
+        }
+    }
+    if (failed)
+    {
+        throw std::runtime_error("❌ Error: Bulk encryption failed");
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] Bulk encryption time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+    return encryptedValues;
+}
+
+std::vector<uint8_t> BulkCipher::decrypt(const std::vector<uint8_t> &data, const std::vector<uint8_t> &key, uint32_t streamId) const
+{
+    /**
+     * Function to decrypt and authenticate a stream of sealed chunks
+     *
+     * @param data: The chunks written by encrypt
+     * @param key: The KEY_BYTES session key
+     * @param streamId: The id the stream was encrypted with
+     *
+     * @return: The decrypted data (throws std::invalid_argument if any chunk fails authentication)
+     */
+    if (key.size() != KEY_BYTES)
+    {
+        throw std::invalid_argument("❌ Error: Invalid session key size");
+    }
+    const size_t sealedChunk = CHUNK_SIZE + TAG_BYTES;
+    const size_t chunks = (data.size() + sealedChunk - 1) / sealedChunk;
+    if (chunks == 0 || data.size() - (chunks - 1) * sealedChunk < TAG_BYTES)
+    {
+        throw std::invalid_argument("❌ Error: Invalid encrypted data length (truncated chunk)");
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<uint8_t> decryptedValues(data.size() - chunks * TAG_BYTES);
+    bool failed = false;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+    {
+#ifdef _OPENMP
+        if (chunk == 0)
+        {
+            printf("\033[1;36m🔵 [OpenMP (%s)] Threads used for decryption: %d\033[0m\n", name.c_str(), omp_get_num_threads());
+        }
+#endif
+        size_t offset = chunk * CHUNK_SIZE;
+        size_t size = std::min(CHUNK_SIZE, decryptedValues.size() - offset);
+        if (!decryptChunk(data.data() + chunk * sealedChunk, size, key.data(), streamId, chunk, chunk + 1 == chunks,
+                          decryptedValues.data() + offset))
+        {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+            failed = true;
+        }
+    }
+    if (failed)
+    {
+        throw std::invalid_argument("❌ Error: Bulk decryption failed (wrong key or corrupted data)");
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] Bulk decryption time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+    return decryptedValues;
+}
@@ -0,0 +1,35 @@
+#ifndef BULK_CIPHER_H
+#define BULK_CIPHER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Authenticated symmetric encryption for the hybrid mode: a random 256-bit session key, wrapped
+// with RSA, encrypts the data with AES-256-GCM or ChaCha20-Poly1305 through OpenSSL EVP. The data
+// is cut into chunks of CHUNK_SIZE bytes that are sealed independently (in parallel), each one
+// followed by its 16-byte tag. The nonce of a chunk is its stream id (4 bytes) and its index
+// (8 bytes), so a key never reuses a nonce as long as stream ids are unique, and the last chunk
+// is marked in its associated data so dropping trailing chunks is detected.
+class BulkCipher
+{
+private:
+    std::string name;
+
+public:
+    static constexpr size_t KEY_BYTES = 32;
+    static constexpr size_t NONCE_BYTES = 12;
+    static constexpr size_t TAG_BYTES = 16;
+    static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+    explicit BulkCipher(const std::string &name);
+    static bool isSupported(const std::string &name);
+    static std::vector<uint8_t> generateKey();
+    bool encryptChunk(const uint8_t *in, size_t size, const uint8_t *key, uint32_t streamId, uint64_t index, bool last, uint8_t *out) const;
+    bool decryptChunk(const uint8_t *in, size_t size, const uint8_t *key, uint32_t streamId, uint64_t index, bool last, uint8_t *out) const;
+    std::vector<uint8_t> encrypt(const std::vector<uint8_t> &data, const std::vector<uint8_t> &key, uint32_t streamId) const;
+    std::vector<uint8_t> decrypt(const std::vector<uint8_t> &data, const std::vector<uint8_t> &key, uint32_t streamId) const;
+};
+
+#endif
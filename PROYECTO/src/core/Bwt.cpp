@@ -0,0 +1,387 @@
+#include "Bwt.h"
+#include <omp.h>
+#include <chrono>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <cstring>
+
+Bwt::Bwt() : blockSize(DEFAULT_BLOCK_SIZE) {
+    /**
+     * Constructor for the Bwt class
+     *
+     * @return: None
+     */
+}
+
+void Bwt::setBlockSize(size_t size) {
+    /**
+     * Function to set the size of the blocks sorted independently. Larger blocks find more
+     * context (better ratio) but take more memory and time per block.
+     *
+     * @param size: The block size in bytes, between MIN_BLOCK_SIZE and MAX_BLOCK_SIZE
+     *
+     * @return: None
+     */
+    if (size < MIN_BLOCK_SIZE || size > MAX_BLOCK_SIZE) {
+        throw std::invalid_argument("❌ Error: BWT block size must be between " + std::to_string(MIN_BLOCK_SIZE) +
+                                    " and " + std::to_string(MAX_BLOCK_SIZE) + " bytes");
+    }
+    blockSize = size;
+}
+
+void Bwt::suffixArray(const int32_t *text, int32_t *sa, int32_t size, int32_t alphabetSize) {
+    /**
+     * Function to build the suffix array of a text in linear time with induced sorting (SA-IS):
+     * the LMS substrings are sorted by induction, named, and the order of the LMS suffixes is
+     * obtained by recursing on the names when two of them are equal
+     *
+     * @param text: The text, ending with a unique sentinel 0 smaller than every other symbol
+     * @param sa: Where the suffix array is stored (size entries, also used as scratch space)
+     * @param size: The length of the text, sentinel included
+     * @param alphabetSize: The number of different symbol values (symbols are below it)
+     *
+     * @return: None
+     */
+    std::vector<uint8_t> sType(size);  // 1 if the suffix is smaller than the next one
+    sType[size - 1] = 1;
+    for (int32_t i = size - 2; i >= 0; --i) {
+        sType[i] = text[i] < text[i + 1] || (text[i] == text[i + 1] && sType[i + 1]);
+    }
+    auto isLms = [&](int32_t i) { return i > 0 && sType[i] && !sType[i - 1]; };
+
+    std::vector<int32_t> counts(alphabetSize, 0), bucket(alphabetSize);
+    for (int32_t i = 0; i < size; ++i) counts[text[i]]++;
+    auto bucketStarts = [&]() {
+        int32_t sum = 0;
+        for (int32_t symbol = 0; symbol < alphabetSize; ++symbol) {
+            bucket[symbol] = sum;
+            sum += counts[symbol];
+        }
+    };
+    auto bucketEnds = [&]() {
+        int32_t sum = 0;
+        for (int32_t symbol = 0; symbol < alphabetSize; ++symbol) {
+            sum += counts[symbol];
+            bucket[symbol] = sum;
+        }
+    };
+    auto induce = [&]() {
+        bucketStarts();
+        for (int32_t i = 0; i < size; ++i) {
+            int32_t j = sa[i] - 1;
+            if (sa[i] > 0 && !sType[j]) sa[bucket[text[j]]++] = j;
+        }
+        bucketEnds();
+        for (int32_t i = size - 1; i >= 0; --i) {
+            int32_t j = sa[i] - 1;
+            if (sa[i] > 0 && sType[j]) sa[--bucket[text[j]]] = j;
+        }
+    };
+
+    // Sort the LMS substrings
+    std::fill(sa, sa + size, -1);
+    bucketEnds();
+    for (int32_t i = 1; i < size; ++i) {
+        if (isLms(i)) sa[--bucket[text[i]]] = i;
+    }
+    induce();
+
+    // Name them, equal substrings getting the same name
+    int32_t lmsCount = 0;
+    for (int32_t i = 0; i < size; ++i) {
+        if (isLms(sa[i])) sa[lmsCount++] = sa[i];
+    }
+    std::fill(sa + lmsCount, sa + size, -1);
+    int32_t names = 0, previous = -1;
+    for (int32_t i = 0; i < lmsCount; ++i) {
+        int32_t position = sa[i];
+        bool different = previous < 0;
+        for (int32_t d = 0; !different; ++d) {
+            if (text[position + d] != text[previous + d] || sType[position + d] != sType[previous + d]) {
+                different = true;
+            } else if (d > 0 && (isLms(position + d) || isLms(previous + d))) {
+                break;
+            }
+        }
+        if (different) {
+            names++;
+            previous = position;
+        }
+        sa[lmsCount + position / 2] = names - 1;
+    }
+    for (int32_t i = size - 1, j = size - 1; i >= lmsCount; --i) {
+        if (sa[i] >= 0) sa[j--] = sa[i];
+    }
+
+    // Sort the LMS suffixes, recursing while names repeat
+    int32_t *reduced = sa + size - lmsCount;
+    if (names < lmsCount) {
+        suffixArray(reduced, sa, lmsCount, names);
+    } else {
+        for (int32_t i = 0; i < lmsCount; ++i) sa[reduced[i]] = i;
+    }
+
+    // Induce the order of all suffixes from the sorted LMS suffixes
+    bucketEnds();
+    for (int32_t i = 1, j = 0; i < size; ++i) {
+        if (isLms(i)) reduced[j++] = i;
+    }
+    for (int32_t i = 0; i < lmsCount; ++i) sa[i] = reduced[sa[i]];
+    std::fill(sa + lmsCount, sa + size, -1);
+    for (int32_t i = lmsCount - 1; i >= 0; --i) {
+        int32_t j = sa[i];
+        sa[i] = -1;
+        sa[--bucket[text[j]]] = j;
+    }
+    induce();
+}
+
+uint32_t Bwt::forwardBlock(const uint8_t *data, size_t size, std::vector<uint8_t> &out) {
+    /**
+     * Function to compute the Burrows-Wheeler transform of a block: the byte before every
+     * suffix, in suffix order
+     *
+     * @param data: The block
+     * @param size: The size of the block (at least 1)
+     * @param out: Where the last column is stored (size bytes, the sentinel is left out)
+     *
+     * @return: The primary index (the row where the sentinel would be)
+     */
+    std::vector<int32_t> text(size + 1), sa(size + 1);
+    for (size_t i = 0; i < size; ++i) text[i] = data[i] + 1;
+    text[size] = 0;
+    suffixArray(text.data(), sa.data(), static_cast<int32_t>(size + 1), 257);
+
+    out.resize(size);
+    uint32_t primary = 0;
+    size_t k = 0;
+    for (size_t row = 0; row <= size; ++row) {
+        if (sa[row] == 0) {
+            primary = static_cast<uint32_t>(row);
+        } else {
+            out[k++] = data[sa[row] - 1];
+        }
+    }
+    return primary;
+}
+
+void Bwt::encodeBlock(const std::vector<uint8_t> &lastColumn, std::vector<uint8_t> &out) {
+    /**
+     * Function to move-to-front code the last column and replace the runs of zeros by their
+     * length in bijective base 2 (RUN_A, RUN_B). Other values v are written as v + 1, and the
+     * two that do not fit a byte as ESCAPE followed by v - 254.
+     *
+     * @param lastColumn: The output of forwardBlock
+     * @param out: Where the coded block is appended
+     *
+     * @return: None
+     */
+    uint8_t order[256];
+    std::iota(order, order + 256, 0);
+    size_t zeros = 0;
+    auto flushZeros = [&]() {
+        if (!zeros) return;
+        size_t pending = zeros - 1;
+        while (true) {
+            out.push_back(pending & 1 ? RUN_B : RUN_A);
+            if (pending < 2) break;
+            pending = (pending - 2) / 2;
+        }
+        zeros = 0;
+    };
+    for (uint8_t byte : lastColumn) {
+        if (order[0] == byte) {
+            zeros++;
+            continue;
+        }
+        flushZeros();
+        size_t value = 1;
+        while (order[value] != byte) value++;
+        std::memmove(order + 1, order, value);
+        order[0] = byte;
+        if (value < 254) {
+            out.push_back(static_cast<uint8_t>(value + 1));
+        } else {
+            out.push_back(ESCAPE);
+            out.push_back(static_cast<uint8_t>(value - 254));
+        }
+    }
+    flushZeros();
+}
+
+bool Bwt::decodeBlock(const uint8_t *in, size_t inSize, uint32_t primary, uint8_t *out, size_t size) {
+    /**
+     * Function to undo encodeBlock and the Burrows-Wheeler transform of one block
+     *
+     * @param in: The coded block
+     * @param inSize: The size of the coded block
+     * @param primary: The primary index of the block
+     * @param out: Where the block is written
+     * @param size: The size of the block
+     *
+     * @return: false if the coded block is corrupted
+     */
+    if (primary < 1 || primary > size) return false;
+
+    // Zero runs and move-to-front
+    std::vector<uint8_t> lastColumn(size);
+    uint8_t order[256];
+    std::iota(order, order + 256, 0);
+    size_t k = 0, run = 0, weight = 1;
+    for (size_t position = 0; position < inSize; ++position) {
+        uint8_t symbol = in[position];
+        if (symbol == RUN_A || symbol == RUN_B) {
+            run += symbol == RUN_A ? weight : 2 * weight;
+            weight <<= 1;
+            if (run > size) return false;
+            continue;
+        }
+        if (run > size - k) return false;
+        std::memset(lastColumn.data() + k, order[0], run);
+        k += run;
+        run = 0;
+        weight = 1;
+
+        size_t value = symbol - 1;
+        if (symbol == ESCAPE) {
+            if (++position >= inSize || in[position] > 1) return false;
+            value = 254 + in[position];
+        }
+        if (k >= size) return false;
+        uint8_t byte = order[value];
+        std::memmove(order + 1, order, value);
+        order[0] = byte;
+        lastColumn[k++] = byte;
+    }
+    if (run != size - k) return false;
+    std::memset(lastColumn.data() + k, order[0], run);
+
+    // Inverse transform: follow the last-to-first mapping from the sentinel row backwards
+    size_t next[256];
+    size_t counts[256] = {0};
+    for (uint8_t byte : lastColumn) counts[byte]++;
+    size_t sum = 1;  // Row 0 is the sentinel suffix
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        next[symbol] = sum;
+        sum += counts[symbol];
+    }
+    std::vector<uint32_t> lastToFirst(size + 1);
+    for (size_t row = 0; row <= size; ++row) {
+        if (row == primary) {
+            lastToFirst[row] = 0;
+            continue;
+        }
+        lastToFirst[row] = static_cast<uint32_t>(next[lastColumn[row < primary ? row : row - 1]]++);
+    }
+    size_t row = 0;
+    for (size_t i = size; i-- > 0;) {
+        if (row == primary) return false;
+        out[i] = lastColumn[row < primary ? row : row - 1];
+        row = lastToFirst[row];
+    }
+    return true;
+}
+
+std::vector<char> Bwt::compress(const std::vector<char> &data) const {
+    /**
+     * Function to apply the Burrows-Wheeler, move-to-front and zero-run stage. Blocks are
+     * transformed in parallel with OpenMP.
+     *
+     * @param data: The data to be transformed
+     *
+     * @return: The header (block size, output size, primary index and coded size of every
+     *          block) followed by the coded blocks
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    int numThreads = omp_get_max_threads();
+    printf("\033[1;36m🔵 [OpenMP (BWT)] Threads used for sorting blocks: %d\033[0m\n", numThreads);
+
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    size_t numBlocks = (data.size() + blockSize - 1) / blockSize;
+    std::vector<std::vector<uint8_t>> coded(numBlocks);
+    std::vector<uint32_t> primaries(numBlocks);
+    #pragma omp parallel for schedule(dynamic)
+    for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+        size_t first = static_cast<size_t>(block) * blockSize;
+        size_t count = std::min(blockSize, data.size() - first);
+        std::vector<uint8_t> lastColumn;
+        primaries[block] = forwardBlock(bytes + first, count, lastColumn);
+        coded[block].reserve(count / 2);
+        encodeBlock(lastColumn, coded[block]);
+    }
+
+    std::vector<char> out;
+    auto put = [&out](uint64_t value, unsigned bytes) {
+        for (unsigned i = 0; i < bytes; ++i) out.push_back(static_cast<char>(value >> (8 * i)));
+    };
+    put(blockSize, 4);
+    put(data.size(), 8);
+    for (size_t block = 0; block < numBlocks; ++block) {
+        put(primaries[block], 4);
+        put(coded[block].size(), 4);
+    }
+    for (const std::vector<uint8_t> &block : coded) out.insert(out.end(), block.begin(), block.end());
+
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] BWT compress time: %lld ms (%zu -> %zu bytes)\033[0m\n",
+           static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()), data.size(), out.size());
+    return out;
+}
+
+std::vector<char> Bwt::uncompress(const std::vector<char> &data) {
+    /**
+     * Function to undo the Burrows-Wheeler stage, decoding the blocks in parallel with OpenMP
+     *
+     * @param data: The output of compress
+     *
+     * @return: The original data (throws std::invalid_argument if the stream is corrupted)
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    const uint8_t *in = reinterpret_cast<const uint8_t *>(data.data());
+    auto get = [in](size_t offset, unsigned bytes) {
+        uint64_t value = 0;
+        for (unsigned i = 0; i < bytes; ++i) value |= static_cast<uint64_t>(in[offset + i]) << (8 * i);
+        return value;
+    };
+    if (data.size() < HEADER_BYTES) {
+        throw std::invalid_argument("❌ Error: Invalid BWT header");
+    }
+    size_t blockSize = get(0, 4);
+    uint64_t outputSize = get(4, 8);
+    if (blockSize < MIN_BLOCK_SIZE || blockSize > MAX_BLOCK_SIZE ||
+        outputSize / blockSize > (data.size() - HEADER_BYTES) / BLOCK_HEADER_BYTES) {
+        throw std::invalid_argument("❌ Error: Invalid BWT header");
+    }
+    size_t numBlocks = (outputSize + blockSize - 1) / blockSize;
+    if (numBlocks * BLOCK_HEADER_BYTES > data.size() - HEADER_BYTES) {
+        throw std::invalid_argument("❌ Error: Invalid BWT header");
+    }
+    std::vector<uint32_t> primaries(numBlocks);
+    std::vector<size_t> offsets(numBlocks + 1);
+    offsets[0] = HEADER_BYTES + numBlocks * BLOCK_HEADER_BYTES;
+    for (size_t block = 0; block < numBlocks; ++block) {
+        primaries[block] = static_cast<uint32_t>(get(HEADER_BYTES + block * BLOCK_HEADER_BYTES, 4));
+        offsets[block + 1] = offsets[block] + get(HEADER_BYTES + block * BLOCK_HEADER_BYTES + 4, 4);
+    }
+    if (offsets[numBlocks] != data.size()) {
+        throw std::invalid_argument("❌ Error: Invalid BWT header");
+    }
+
+    std::vector<char> decoded(outputSize);
+    uint8_t *out = reinterpret_cast<uint8_t *>(decoded.data());
+    std::vector<uint8_t> valid(numBlocks);
+    #pragma omp parallel for schedule(dynamic)
+    for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+        size_t first = static_cast<size_t>(block) * blockSize;
+        size_t count = std::min<size_t>(blockSize, outputSize - first);
+        valid[block] = decodeBlock(in + offsets[block], offsets[block + 1] - offsets[block], primaries[block], out + first, count);
+    }
+    if (std::find(valid.begin(), valid.end(), 0) != valid.end()) {
+        throw std::invalid_argument("❌ Error: Corrupted BWT stream");
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] BWT uncompress time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+    return decoded;
+}
@@ -0,0 +1,38 @@
+#ifndef BWT_H
+#define BWT_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Burrows-Wheeler stage of the high-ratio level: every block is sorted with a suffix array
+// (SA-IS), then move-to-front and zero-run coded, so the entropy coder receives mostly small
+// values. Blocks are independent and are transformed in parallel.
+class Bwt {
+private:
+    static constexpr size_t HEADER_BYTES = 4 + 8;        // Block size, output size
+    static constexpr size_t BLOCK_HEADER_BYTES = 4 + 4;  // Primary index, encoded size
+    static constexpr uint8_t RUN_A = 0;  // Zero-run digits (bijective base 2, as in bzip2)
+    static constexpr uint8_t RUN_B = 1;
+    static constexpr uint8_t ESCAPE = 255;  // Followed by 0 or 1 for the move-to-front values 254 and 255
+
+    size_t blockSize;
+
+    static void suffixArray(const int32_t *text, int32_t *sa, int32_t size, int32_t alphabetSize);
+    static uint32_t forwardBlock(const uint8_t *data, size_t size, std::vector<uint8_t> &out);
+    static void encodeBlock(const std::vector<uint8_t> &lastColumn, std::vector<uint8_t> &out);
+    static bool decodeBlock(const uint8_t *in, size_t inSize, uint32_t primary, uint8_t *out, size_t size);
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = size_t(1) << 22;
+    static constexpr size_t MIN_BLOCK_SIZE = size_t(1) << 10;
+    static constexpr size_t MAX_BLOCK_SIZE = size_t(1) << 24;
+
+    Bwt();
+    void setBlockSize(size_t size);
+    std::vector<char> compress(const std::vector<char> &data) const;
+    static std::vector<char> uncompress(const std::vector<char> &data);
+};
+
+#endif
@@ -0,0 +1,465 @@
+#include "ContextHuffman.h"
+#include "Huffman.h"
+#include "../helpers/BitStream.h"
+#include <omp.h>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+ContextHuffman::ContextHuffman() : contextTable{}, codeLengths(256, 0), codes(256, 0), blockSize(DEFAULT_BLOCK_SIZE) {
+    /**
+     * Constructor for the ContextHuffman class
+     *
+     * @return: None
+     */
+}
+
+std::string ContextHuffman::getName() const {
+    /**
+     * Function to retrieve the name under which archives record this coder
+     *
+     * @return: "huffman-o1"
+     */
+    return "huffman-o1";
+}
+
+std::vector<FrequencyTable> ContextHuffman::countContexts(const std::vector<char> &data) const {
+    /**
+     * Function to count every (previous byte, byte) pair. The context is reset to 0 at the
+     * start of every block, exactly like compress does, so that every pair the encoder meets
+     * gets a code. Every thread counts whole blocks into its own counters.
+     *
+     * @param data: The data to be compressed
+     *
+     * @return: The histogram of the bytes that follow every byte value
+     */
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    size_t numBlocks = (data.size() + blockSize - 1) / blockSize;
+    std::vector<std::vector<uint64_t>> threadCounts(omp_get_max_threads());
+    #pragma omp parallel
+    {
+        std::vector<uint64_t> &counts = threadCounts[omp_get_thread_num()];
+        counts.assign(256 * 256, 0);
+        #pragma omp for schedule(static)
+        for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+            size_t first = static_cast<size_t>(block) * blockSize;
+            size_t last = std::min(first + blockSize, data.size());
+            unsigned context = 0;
+            for (size_t i = first; i < last; ++i) {
+                counts[(context << 8) | bytes[i]]++;
+                context = bytes[i];
+            }
+        }
+    }
+
+    std::vector<FrequencyTable> contexts(256, FrequencyTable{});
+    for (const std::vector<uint64_t> &counts : threadCounts) {
+        if (counts.empty()) continue;
+        for (int context = 0; context < 256; ++context) {
+            for (int symbol = 0; symbol < 256; ++symbol) {
+                contexts[context][symbol] += counts[(context << 8) | symbol];
+            }
+        }
+    }
+    return contexts;
+}
+
+void ContextHuffman::buildModel(const FrequencyTable &frequencies) {
+    /**
+     * Function to build an order-0 model: every context uses one table built from the
+     * byte frequencies
+     *
+     * @param frequencies: The frequency of every byte value
+     *
+     * @return: None
+     */
+    std::fill(contextTable, contextTable + 256, 0);
+    codeLengths = Huffman::limitedCodeLengths(frequencies, CODE_BITS);
+    assignCanonicalCodes();
+}
+
+void ContextHuffman::fitModel(const std::vector<char> &data) {
+    /**
+     * Function to build the order-1 model of the data. Every context first gets the optimal
+     * (length-limited) table of its own histogram. A context keeps it only if it saves more
+     * than the table costs to store compared with the order-0 table; the others are pooled,
+     * and the fallback table is rebuilt from the pooled histogram alone.
+     *
+     * @param data: The data to be compressed
+     *
+     * @return: None
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<FrequencyTable> contexts = countContexts(data);
+    FrequencyTable all{};
+    for (const FrequencyTable &context : contexts) {
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            all[symbol] += context[symbol];
+        }
+    }
+    std::vector<uint8_t> shared = Huffman::limitedCodeLengths(all, CODE_BITS);
+
+    std::vector<std::vector<uint8_t>> own(256);
+    std::vector<char> keep(256, 0);
+    std::vector<char> used(256, 0);
+    #pragma omp parallel for schedule(dynamic)
+    for (int context = 0; context < 256; ++context) {
+        const FrequencyTable &frequencies = contexts[context];
+        if (std::all_of(frequencies.begin(), frequencies.end(), [](uint64_t count) { return count == 0; })) continue;
+        used[context] = 1;
+        own[context] = Huffman::limitedCodeLengths(frequencies, CODE_BITS);
+        uint64_t ownBits = TABLE_COST_BITS, sharedBits = 0;
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            ownBits += frequencies[symbol] * own[context][symbol];
+            sharedBits += frequencies[symbol] * shared[symbol];
+        }
+        keep[context] = ownBits < sharedBits;
+    }
+
+    FrequencyTable pooled{};
+    bool anyPooled = false;
+    for (int context = 0; context < 256; ++context) {
+        if (!used[context] || keep[context]) continue;
+        anyPooled = true;
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            pooled[symbol] += contexts[context][symbol];
+        }
+    }
+    if (anyPooled) shared = Huffman::limitedCodeLengths(pooled, CODE_BITS);
+
+    // Kept contexts are numbered first, the fallback table (if any context uses it) goes last
+    codeLengths.clear();
+    unsigned tables = 0;
+    for (int context = 0; context < 256; ++context) {
+        if (!keep[context]) continue;
+        contextTable[context] = static_cast<uint8_t>(tables++);
+        codeLengths.insert(codeLengths.end(), own[context].begin(), own[context].end());
+    }
+    if (tables < 256) {
+        for (int context = 0; context < 256; ++context) {
+            if (!keep[context]) contextTable[context] = static_cast<uint8_t>(tables);
+        }
+        codeLengths.insert(codeLengths.end(), shared.begin(), shared.end());
+    }
+    assignCanonicalCodes();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    printf("\033[1;32m🟢 [Timing] Building %zu context tables time: %lld ms\033[0m\n", getTableCount(), static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+}
+
+void ContextHuffman::assignCanonicalCodes() {
+    /**
+     * Function to assign the canonical codes of every table from its code lengths (same
+     * scheme as Huffman: codes of one length are consecutive in symbol order)
+     *
+     * @return: None
+     */
+    codes.assign(codeLengths.size(), 0);
+    for (size_t table = 0; table < getTableCount(); ++table) {
+        const uint8_t *lengths = codeLengths.data() + table * 256;
+        uint32_t lengthCount[CODE_BITS + 1] = {0};
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            lengthCount[lengths[symbol]]++;
+        }
+        lengthCount[0] = 0;
+        uint32_t nextCode[CODE_BITS + 1] = {0};
+        uint32_t code = 0;
+        for (unsigned length = 1; length <= CODE_BITS; ++length) {
+            code = (code + lengthCount[length - 1]) << 1;
+            nextCode[length] = code;
+        }
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            unsigned length = lengths[symbol];
+            codes[table * 256 + symbol] = length ? static_cast<uint16_t>(nextCode[length]++) : 0;
+        }
+    }
+}
+
+void ContextHuffman::buildDecodeTable() {
+    /**
+     * Function to build one single-level lookup table per context table. Codes are at most
+     * CODE_BITS long, so every symbol is resolved by one lookup.
+     *
+     * @return: None
+     */
+    const size_t tableSize = size_t(1) << CODE_BITS;
+    decodeTable.assign(getTableCount() * tableSize, 0);
+    for (size_t table = 0; table < getTableCount(); ++table) {
+        uint16_t *entries = decodeTable.data() + table * tableSize;
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            unsigned length = codeLengths[table * 256 + symbol];
+            if (!length) continue;
+            size_t first = static_cast<size_t>(codes[table * 256 + symbol]) << (CODE_BITS - length);
+            size_t count = size_t(1) << (CODE_BITS - length);
+            std::fill(entries + first, entries + first + count, static_cast<uint16_t>(symbol | (length << 8)));
+        }
+    }
+}
+
+size_t ContextHuffman::getTableCount() const {
+    /**
+     * Function to retrieve how many code tables the model holds (kept contexts plus fallback)
+     *
+     * @return: The number of tables
+     */
+    return codeLengths.size() / 256;
+}
+
+std::vector<uint8_t> ContextHuffman::getTable() const {
+    /**
+     * Function to serialize the model: the table index of every context, followed by the
+     * code lengths of every table packed two per byte
+     *
+     * @return: The table that setTable (or uncompress) needs to decode the stream
+     */
+    std::vector<uint8_t> table(contextTable, contextTable + 256);
+    for (size_t i = 0; i < codeLengths.size(); i += 2) {
+        table.push_back(static_cast<uint8_t>((codeLengths[i] << 4) | codeLengths[i + 1]));
+    }
+    return table;
+}
+
+void ContextHuffman::setTable(const std::vector<uint8_t> &table) {
+    /**
+     * Function to load a model serialized by getTable
+     *
+     * @param table: The context map followed by the packed code lengths of every table
+     *
+     * @return: None (throws std::invalid_argument if the table is not valid)
+     */
+    if (table.size() < 256 + PACKED_TABLE_BYTES || (table.size() - 256) % PACKED_TABLE_BYTES != 0 ||
+        (table.size() - 256) / PACKED_TABLE_BYTES > MAX_TABLES) {
+        throw std::invalid_argument("❌ Error: Invalid order-1 Huffman table");
+    }
+    size_t tables = (table.size() - 256) / PACKED_TABLE_BYTES;
+    for (int context = 0; context < 256; ++context) {
+        if (table[context] >= tables) {
+            throw std::invalid_argument("❌ Error: Order-1 Huffman context refers to a missing table");
+        }
+    }
+
+    std::vector<uint8_t> lengths;
+    lengths.reserve(tables * 256);
+    for (size_t i = 256; i < table.size(); ++i) {
+        lengths.push_back(table[i] >> 4);
+        lengths.push_back(table[i] & 0x0F);
+    }
+    for (size_t index = 0; index < tables; ++index) {
+        uint64_t kraftSum = 0;
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            unsigned length = lengths[index * 256 + symbol];
+            if (length > CODE_BITS) {
+                throw std::invalid_argument("❌ Error: Order-1 Huffman code length exceeds the supported maximum");
+            }
+            if (length) kraftSum += 1ull << (CODE_BITS - length);
+        }
+        if (kraftSum > (1ull << CODE_BITS)) {
+            throw std::invalid_argument("❌ Error: Order-1 Huffman code lengths do not describe a prefix code");
+        }
+    }
+    std::copy(table.begin(), table.begin() + 256, contextTable);
+    codeLengths = lengths;
+    assignCanonicalCodes();
+}
+
+std::vector<uint8_t> ContextHuffman::compress(const std::vector<char> &data) {
+    /**
+     * Function to compress a given set of data with the order-1 tables. Like the static
+     * Huffman mode, a first parallel pass sums the code lengths of every block and a second
+     * one writes every block into its bit range of one preallocated buffer. The context is
+     * reset at every block start so that blocks decode independently.
+     *
+     * @param data: The input data to be compressed
+     *
+     * @return: A vector containing the packed bit stream
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    int numThreads = omp_get_max_threads();
+    printf("\033[1;36m🔵 [OpenMP (Huffman order-1)] Threads used for compress: %d\033[0m\n", numThreads);
+
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    size_t numBlocks = (data.size() + blockSize - 1) / blockSize;
+    std::vector<uint64_t> blockBits(numBlocks, 0);
+    bool valid = true;
+    #pragma omp parallel for schedule(static) reduction(&& : valid)
+    for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+        size_t first = static_cast<size_t>(block) * blockSize;
+        size_t last = std::min(first + blockSize, data.size());
+        unsigned context = 0;
+        uint64_t bits = 0;
+        bool present = true;
+        for (size_t i = first; i < last; ++i) {
+            unsigned length = codeLengths[contextTable[context] * 256 + bytes[i]];
+            present &= length != 0;
+            bits += length;
+            context = bytes[i];
+        }
+        blockBits[block] = bits;
+        valid = valid && present;
+    }
+    if (!valid) {
+        throw std::invalid_argument("❌ Error: Data holds a byte pair that is not in the order-1 Huffman model");
+    }
+
+    blocks.assign(numBlocks, CodedBlock{0, 0, false, {}});
+    uint64_t totalBits = 0;
+    for (size_t block = 0; block < numBlocks; ++block) {
+        blocks[block] = CodedBlock{totalBits, block * blockSize, false, {}};
+        totalBits += blockBits[block];
+    }
+
+    std::vector<uint8_t> compressedData((totalBits + 7) / 8, 0);
+    #pragma omp parallel for schedule(static)
+    for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+        size_t first = static_cast<size_t>(block) * blockSize;
+        size_t last = std::min(first + blockSize, data.size());
+        OffsetBitWriter writer(compressedData.data(), blocks[block].bitOffset);
+        unsigned context = 0;
+        for (size_t i = first; i < last; ++i) {
+            size_t index = contextTable[context] * 256 + bytes[i];
+            writer.write(codes[index], codeLengths[index]);
+            context = bytes[i];
+        }
+        writer.flush();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] Compress time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+    return compressedData;
+}
+
+bool ContextHuffman::decodeBlock(const std::vector<uint8_t> &data, uint64_t bitOffset, char *output, size_t count) const {
+    /**
+     * Function to decode `count` symbols starting at a given bit of the stream. Every decoded
+     * byte selects the table of the next lookup.
+     *
+     * @param data: The packed bit stream produced by compress
+     * @param bitOffset: The bit where the block starts
+     * @param output: Where the decoded symbols are written
+     * @param count: The number of symbols to decode
+     *
+     * @return: true if all the symbols were decoded, false if the stream holds an invalid code
+     */
+    uint32_t contextBase[256];
+    for (int context = 0; context < 256; ++context) {
+        contextBase[context] = static_cast<uint32_t>(contextTable[context]) << CODE_BITS;
+    }
+    const uint16_t *table = decodeTable.data();
+    BitReader reader(data.data(), data.size(), bitOffset);
+
+    // A refill leaves at least 56 bits, enough for SYMBOLS_PER_REFILL codes
+    constexpr unsigned SYMBOLS_PER_REFILL = 56 / CODE_BITS;
+    unsigned context = 0;
+    bool valid = true;
+    size_t i = 0;
+    for (; i + SYMBOLS_PER_REFILL <= count; i += SYMBOLS_PER_REFILL) {
+        reader.refill();
+        for (unsigned k = 0; k < SYMBOLS_PER_REFILL; ++k) {
+            uint16_t entry = table[contextBase[context] + reader.peek(CODE_BITS)];
+            valid &= entry >= 0x100;
+            context = entry & 0xFF;
+            output[i + k] = static_cast<char>(context);
+            reader.consume(entry >> 8);
+        }
+    }
+    for (; i < count; ++i) {
+        reader.refill();
+        uint16_t entry = table[contextBase[context] + reader.peek(CODE_BITS)];
+        valid &= entry >= 0x100;
+        context = entry & 0xFF;
+        output[i] = static_cast<char>(context);
+        reader.consume(entry >> 8);
+    }
+    return valid;
+}
+
+std::vector<char> ContextHuffman::uncompress(const std::vector<uint8_t> &data, size_t outputSize,
+    const std::vector<uint8_t>* externalTable, const std::vector<CodedBlock>* externalBlocks) {
+    /**
+     * Function to decompress order-1 Huffman data. The blocks are decoded in parallel with
+     * OpenMP, each one straight into its place in the preallocated output.
+     *
+     * @param data: The packed bit stream produced by compress
+     * @param outputSize: The number of symbols to decode
+     * @param externalTable: A pointer to a table serialized by getTable, if provided
+     * @param externalBlocks: A pointer to an external block index, if provided
+     *
+     * @return: A vector containing the decompressed data (empty if the stream is invalid)
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (externalTable) {
+        setTable(*externalTable);
+    }
+    if (externalBlocks) {
+        setBlocks(*externalBlocks);
+    }
+    buildDecodeTable();
+
+    std::vector<CodedBlock> index = blocks.empty() ? std::vector<CodedBlock>{CodedBlock{0, 0, false, {}}} : blocks;
+    for (size_t block = 0; block < index.size(); ++block) {
+        uint64_t nextOutput = block + 1 < index.size() ? index[block + 1].outputOffset : outputSize;
+        if (index[block].outputOffset > nextOutput || index[block].bitOffset > data.size() * 8ull || index[block].raw) {
+            throw std::invalid_argument("❌ Error: Invalid order-1 Huffman block index");
+        }
+    }
+
+    std::vector<char> decoded(outputSize);
+    bool valid = true;
+    #pragma omp parallel for schedule(dynamic) reduction(&& : valid)
+    for (long long block = 0; block < static_cast<long long>(index.size()); ++block) {
+        uint64_t first = index[block].outputOffset;
+        uint64_t last = block + 1 < static_cast<long long>(index.size()) ? index[block + 1].outputOffset : outputSize;
+        valid = decodeBlock(data, index[block].bitOffset, decoded.data() + first, last - first) && valid;
+    }
+    if (!valid) {
+        std::cerr << "❌ Error: Invalid Huffman code in compressed stream\n" << std::endl;
+        decoded.clear();
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] Uncompress time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+    return decoded;
+}
+
+std::vector<CodedBlock> ContextHuffman::getBlocks() const {
+    /**
+     * Function to retrieve the block index of the last compressed stream
+     *
+     * @return: The bit offset and output offset of every block
+     */
+    return blocks;
+}
+
+void ContextHuffman::setBlocks(const std::vector<CodedBlock> &blockIndex) {
+    /**
+     * Function to load the block index of a previously compressed stream
+     *
+     * @param blockIndex: The bit offset and output offset of every block
+     *
+     * @return: None
+     */
+    for (size_t block = 1; block < blockIndex.size(); ++block) {
+        if (blockIndex[block].bitOffset < blockIndex[block - 1].bitOffset ||
+            blockIndex[block].outputOffset < blockIndex[block - 1].outputOffset) {
+            throw std::invalid_argument("❌ Error: Order-1 Huffman block index must be in stream order");
+        }
+    }
+    blocks = blockIndex;
+}
+
+void ContextHuffman::setBlockSize(size_t size) {
+    /**
+     * Function to set how many symbols each independently decodable block holds. It must be
+     * set before fitModel, which counts the contexts the same way the blocks reset them.
+     *
+     * @param size: The number of symbols per block
+     *
+     * @return: None
+     */
+    if (size == 0) {
+        throw std::invalid_argument("❌ Error: Huffman block size must be greater than 0");
+    }
+    blockSize = size;
+}
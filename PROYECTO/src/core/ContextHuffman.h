@@ -0,0 +1,50 @@
+#ifndef CONTEXT_HUFFMAN_H
+#define CONTEXT_HUFFMAN_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "EntropyCoder.h"
+#include "../helpers/Histogram.h"
+
+// Order-1 Huffman coder: the table used for every byte is chosen by the byte before it.
+// Contexts too sparse to pay for a table of their own share one fallback table.
+class ContextHuffman : public EntropyCoder {
+private:
+    static constexpr unsigned CODE_BITS = 11;  // Maximum code length, and index width of every decode table
+    static constexpr size_t PACKED_TABLE_BYTES = 256 / 2;  // Code lengths of one table, two per byte
+    static constexpr uint64_t TABLE_COST_BITS = PACKED_TABLE_BYTES * 8;
+    static constexpr size_t MAX_TABLES = 256;
+
+    uint8_t contextTable[256];          // Table used after every byte value
+    std::vector<uint8_t> codeLengths;   // 256 code lengths per table
+    std::vector<uint16_t> codes;        // 256 canonical codes per table
+    std::vector<uint16_t> decodeTable;  // 2^CODE_BITS entries per table: symbol | length << 8
+    size_t blockSize;
+    std::vector<CodedBlock> blocks;
+
+    std::vector<FrequencyTable> countContexts(const std::vector<char> &data) const;
+    void assignCanonicalCodes();
+    void buildDecodeTable();
+    bool decodeBlock(const std::vector<uint8_t> &data, uint64_t bitOffset, char *output, size_t count) const;
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1 << 17;
+
+    ContextHuffman();
+    std::string getName() const override;
+    void buildModel(const FrequencyTable &frequencies) override;
+    void fitModel(const std::vector<char> &data) override;
+    std::vector<uint8_t> getTable() const override;
+    void setTable(const std::vector<uint8_t> &table) override;
+    size_t getTableCount() const;
+    std::vector<CodedBlock> getBlocks() const override;
+    void setBlocks(const std::vector<CodedBlock> &blockIndex) override;
+    void setBlockSize(size_t size) override;
+    std::vector<uint8_t> compress(const std::vector<char> &data) override;
+    std::vector<char> uncompress(const std::vector<uint8_t> &data, size_t outputSize,
+        const std::vector<uint8_t>* externalTable = nullptr,
+        const std::vector<CodedBlock>* externalBlocks = nullptr) override;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef ENTROPY_CODER_H
+#define ENTROPY_CODER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "../helpers/Histogram.h"
+
+struct CodedBlock {
+    uint64_t bitOffset;     // First bit of the block in the compressed stream
+    uint64_t outputOffset;  // Position of its first symbol in the decompressed data
+    bool raw = false;                  // Stored uncompressed (byte aligned)
+    std::vector<uint8_t> codeLengths;  // Table of the block itself, empty to use the stream table
+};
+
+// Common interface of the byte-oriented entropy coders (Huffman, tANS). A coder is built from
+// a histogram, serializes its model as an opaque table and splits its output into
+// independently decodable blocks.
+class EntropyCoder {
+public:
+    virtual ~EntropyCoder() = default;
+
+    virtual std::string getName() const = 0;
+    virtual void buildModel(const FrequencyTable &frequencies) = 0;
+    // Coders whose model is more than a histogram (e.g. per-context tables) override this
+    virtual void fitModel(const std::vector<char> &data) { buildModel(Histogram::count(data)); }
+    virtual std::vector<uint8_t> getTable() const = 0;
+    virtual void setTable(const std::vector<uint8_t> &table) = 0;
+    virtual std::vector<CodedBlock> getBlocks() const = 0;
+    virtual void setBlocks(const std::vector<CodedBlock> &blockIndex) = 0;
+    virtual void setBlockSize(size_t size) = 0;
+    virtual std::vector<uint8_t> compress(const std::vector<char> &data) = 0;
+    virtual std::vector<char> uncompress(const std::vector<uint8_t> &data, size_t outputSize,
+        const std::vector<uint8_t>* externalTable = nullptr,
+        const std::vector<CodedBlock>* externalBlocks = nullptr) = 0;
+};
+
+#endif
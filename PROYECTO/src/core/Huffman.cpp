@@ -1,10 +1,13 @@
 #include "Huffman.h"
+#include "../helpers/BitStream.h"
 #include <omp.h>
-#include <sstream>
 #include <string>
 #include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
 
-Huffman::Huffman() : root(nullptr) {
+Huffman::Huffman() : codes{}, codeLengths{}, flatBits(0), maxCodeLength(0), ratioLoss(0.0), blockSize(DEFAULT_BLOCK_SIZE), adaptive(false), interleaved(false) {
     /**
      * Constructor for the Huffman class
      * 
@@ -12,184 +15,1060 @@ Huffman::Huffman() : root(nullptr) {
      */
 }
 
-Huffman::~Huffman() {
+std::string Huffman::getName() const {
     /**
-     * Destructor for the Huffman class
+     * Function to retrieve the name under which archives record this coder
+     * 
+     * @return: "huffman"
+     */
+    return "huffman";
+}
+
+void Huffman::buildModel(const FrequencyTable &frequencies) {
+    /**
+     * Function to build the coding model from the byte frequencies (see buildTree)
+     * 
+     * @param frequencies: The frequency of every byte value
      * 
      * @return: None
      */
-    deleteTree(root);
+    buildTree(frequencies);
+}
+
+std::vector<uint8_t> Huffman::getTable() const {
+    /**
+     * Function to serialize the model: for Huffman, the 256 code lengths
+     * 
+     * @return: The table that setTable (or uncompress) needs to decode the stream
+     */
+    return getCodeLengths();
 }
 
-void Huffman::deleteTree(Node *node) {
+void Huffman::setTable(const std::vector<uint8_t> &table) {
     /**
-     * Function to delete the Huffman tree recursively
+     * Function to load a model serialized by getTable
      * 
-     * @param node: The root node of the tree to delete
+     * @param table: The 256 code lengths
      * 
      * @return: None
      */
-    if (!node) return;
-    deleteTree(node->left);
-    deleteTree(node->right);
-    delete node;
+    setCodeLengths(table);
 }
 
-void Huffman::buildTree(const std::unordered_map<char, int> &freqMap) {
+void Huffman::buildTree(const FrequencyTable &frequencies) {
     /**
-     * Function to build the Huffman tree based on character frequencies, using OpenMP
-     * to parallelize the node creation phase.
+     * Function to build the Huffman tree based on byte frequencies and derive the code
+     * length of every symbol. If the tree is deeper than the configured maximum code length,
+     * the lengths are recomputed with package-merge.
      * 
-     * @param freqMap: A map containing characters and their corresponding frequencies
+     * @param frequencies: The frequency of every byte value, as counted by Histogram::count
      */
-    
-     // Vector to hold nodes
     auto start = std::chrono::high_resolution_clock::now();
+    buildCodeLengths(frequencies);
+    auto end = std::chrono::high_resolution_clock::now();
 
-    std::vector<Node*> nodes(freqMap.size());
+    printf("\033[1;32m🟢 [Timing] Building tree and generating codes time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
 
-    // Parallelize the node creation
-    std::vector<std::pair<char, int>> entries(freqMap.begin(), freqMap.end());
+}
 
-    int numThreads = omp_get_max_threads();
-    printf("\033[1;36m🔵 [OpenMP (Huffman)] Threads used for building tree: %d\033[0m\n", numThreads);
+void Huffman::buildCodeLengths(const FrequencyTable &frequencies) {
+    /**
+     * Function to derive the (length-limited) code lengths and canonical codes from the
+     * byte frequencies, without any logging, so it can also be used for every block
+     * 
+     * @param frequencies: The frequency of every byte value
+     * 
+     * @return: None
+     */
+    generateCodeLengths(frequencies);
 
+    // Enforce the maximum code length, keeping track of what the cap costs in compressed size
+    unsigned limit = maxCodeLength ? maxCodeLength : MAX_CODE_LENGTH;
+    uint64_t unlimitedBits = 0, limitedBits = 0;
+    unsigned longestCode = 0;
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        unlimitedBits += frequencies[symbol] * codeLengths[symbol];
+        longestCode = std::max<unsigned>(longestCode, codeLengths[symbol]);
+    }
+    limitedBits = unlimitedBits;
+    if (longestCode > limit) {
+        limitCodeLengths(frequencies, limit);
+        limitedBits = 0;
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            limitedBits += frequencies[symbol] * codeLengths[symbol];
+        }
+    }
+    ratioLoss = unlimitedBits ? static_cast<double>(limitedBits - unlimitedBits) / unlimitedBits : 0.0;
+    assignCanonicalCodes();
+}
 
-    #pragma omp parallel for
-    for (int i = 0; i < static_cast<int>(entries.size()); ++i) {
-        const auto& [ch, freq] = entries[i];
-        nodes[i] = new Node(ch, freq);
+void Huffman::generateCodeLengths(const FrequencyTable &frequencies) {
+    /**
+     * Function to build the Huffman tree in the flat `tree` array and collect the code length
+     * of every symbol. The leaves are sorted by frequency into tree[0..n-1] and the internal
+     * nodes are appended after them in the order they are created, which is also increasing
+     * frequency. The two lowest nodes are therefore always at the front of one of two queues
+     * (unmerged leaves and unmerged internal nodes), so the tree is built in linear time.
+     * Every node only records its parent, whose index is always higher than its own, so the
+     * depths come out of one backwards pass. Nothing is allocated and nothing is recursive.
+     * 
+     * @param frequencies: The frequency of every byte value
+     * 
+     * @return: None
+     */
+    std::fill(codeLengths, codeLengths + 256, 0);
+    uint16_t leafSymbol[256];
+    unsigned n = 0;
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        if (frequencies[symbol]) leafSymbol[n++] = static_cast<uint16_t>(symbol);
+    }
+    if (n == 0) return;
+    if (n == 1) {
+        // A single symbol still needs one bit per occurrence to be decodable
+        codeLengths[leafSymbol[0]] = 1;
+        return;
+    }
+    std::stable_sort(leafSymbol, leafSymbol + n, [&](uint16_t a, uint16_t b) {
+        return frequencies[a] < frequencies[b];
+    });
+    for (unsigned i = 0; i < n; ++i) {
+        tree[i] = TreeNode{frequencies[leafSymbol[i]], 0};
     }
 
-    // Create a priority queue to hold the nodes
-    std::priority_queue<Node*, std::vector<Node*>, Compare> pq;
-    for (auto node : nodes) {
-        pq.push(node);
+    unsigned nextLeaf = 0, nextInternal = n, created = n;
+    auto takeLowest = [&]() {
+        if (nextLeaf < n && (nextInternal >= created || tree[nextLeaf].freq <= tree[nextInternal].freq)) {
+            return nextLeaf++;
+        }
+        return nextInternal++;
+    };
+    while (created < 2 * n - 1) {
+        unsigned left = takeLowest();
+        unsigned right = takeLowest();
+        tree[created] = TreeNode{tree[left].freq + tree[right].freq, 0};
+        tree[left].parent = static_cast<uint16_t>(created);
+        tree[right].parent = static_cast<uint16_t>(created);
+        created++;
     }
 
-    // Construir el árbol de Huffman (parte secuencial)
-    while (pq.size() > 1) {
-        Node *left = pq.top(); pq.pop();
-        Node *right = pq.top(); pq.pop();
-        Node *merged = new Node('\0', left->freq + right->freq, left, right);
-        pq.push(merged);
+    // The root is the last node; every other node is one level below its parent
+    uint8_t depth[MAX_TREE_NODES];
+    depth[created - 1] = 0;
+    for (int node = static_cast<int>(created) - 2; node >= 0; --node) {
+        depth[node] = depth[tree[node].parent] + 1;
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        codeLengths[leafSymbol[i]] = depth[i];
     }
+}
 
-    root = pq.top();
-    #pragma omp parallel
-    {
-        #pragma omp single
-        generateCodes(root, "");
+void Huffman::limitCodeLengths(const FrequencyTable &frequencies, unsigned maxLength) {
+    /**
+     * Function to compute optimal code lengths no longer than maxLength with the
+     * package-merge algorithm. Level 1 holds the symbols sorted by frequency; every next
+     * level merges the symbols with the pairwise "packages" of the previous level. The first
+     * 2n - 2 items of the last level form the optimal solution, and every symbol's code
+     * length is the number of levels in which it is part of the selection.
+     * 
+     * @param frequencies: The frequency of every byte value
+     * @param maxLength: The maximum code length allowed
+     * 
+     * @return: None
+     */
+    std::vector<int> symbols;
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        if (frequencies[symbol]) symbols.push_back(symbol);
     }
-    auto end = std::chrono::high_resolution_clock::now();
+    size_t n = symbols.size();
+    if (maxLength < 64 && (1ull << maxLength) < n) {
+        throw std::invalid_argument("❌ Error: Maximum code length is too small for the number of symbols");
+    }
+    std::fill(codeLengths, codeLengths + 256, 0);
+    if (n <= 2) {
+        for (int symbol : symbols) codeLengths[symbol] = 1;
+        return;
+    }
+    std::stable_sort(symbols.begin(), symbols.end(), [&](int a, int b) {
+        return frequencies[a] < frequencies[b];
+    });
 
-    printf("\033[1;32m🟢 [Timing] Building tree and generating codes time: %lld ms\033[0m\n", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    // An item is a symbol (symbol >= 0) or a package of two consecutive items of the previous level
+    struct Item {
+        uint64_t weight;
+        int symbol;
+    };
+    std::vector<std::vector<Item>> levels(maxLength);
+    for (int symbol : symbols) {
+        levels[0].push_back(Item{frequencies[symbol], symbol});
+    }
+    for (unsigned level = 1; level < maxLength; ++level) {
+        const std::vector<Item> &previous = levels[level - 1];
+        std::vector<Item> &current = levels[level];
+        current.reserve(n + previous.size() / 2);
+        size_t leaf = 0, pair = 0;
+        while (leaf < n || pair + 1 < previous.size()) {
+            uint64_t packageWeight = pair + 1 < previous.size() ? previous[pair].weight + previous[pair + 1].weight : 0;
+            if (leaf < n && (pair + 1 >= previous.size() || frequencies[symbols[leaf]] <= packageWeight)) {
+                current.push_back(Item{frequencies[symbols[leaf]], symbols[leaf]});
+                leaf++;
+            } else {
+                current.push_back(Item{packageWeight, -1});
+                pair += 2;
+            }
+        }
+    }
+
+    // Walk the selection back down: k packages selected at one level select the first 2k items below
+    size_t selected = 2 * n - 2;
+    for (int level = static_cast<int>(maxLength) - 1; level >= 0 && selected > 0; --level) {
+        size_t packages = 0;
+        for (size_t i = 0; i < selected; ++i) {
+            const Item &item = levels[level][i];
+            if (item.symbol >= 0) codeLengths[item.symbol]++;
+            else packages++;
+        }
+        selected = 2 * packages;
+    }
+}
+
+std::vector<uint8_t> Huffman::limitedCodeLengths(const FrequencyTable &frequencies, unsigned maxLength) {
+    /**
+     * Function to compute the optimal code lengths no longer than maxLength for a histogram,
+     * without any logging, for coders that keep many small tables of their own
+     * 
+     * @param frequencies: The frequency of every byte value
+     * @param maxLength: The maximum code length allowed
+     * 
+     * @return: A vector of 256 code lengths (0 for unused byte values)
+     */
+    Huffman local;
+    local.setMaxCodeLength(maxLength);
+    local.buildCodeLengths(frequencies);
+    return local.getCodeLengths();
+}
 
+void Huffman::setMaxCodeLength(unsigned maxLength) {
+    /**
+     * Function to cap the code length used by the next buildTree call
+     * 
+     * @param maxLength: The maximum code length in bits, or 0 for no limit other than MAX_CODE_LENGTH
+     * 
+     * @return: None
+     */
+    if (maxLength > MAX_CODE_LENGTH) {
+        throw std::invalid_argument("❌ Error: Maximum code length can not exceed " + std::to_string(MAX_CODE_LENGTH) + " bits");
+    }
+    maxCodeLength = maxLength;
 }
 
-void Huffman::generateCodes(Node *node, const std::string &code) {
+double Huffman::getRatioLoss() const {
     /**
-     * Function to generate Huffman codes from the tree
+     * Function to retrieve how much larger the encoded data is because of the code length cap
      * 
-     * @param node: The current node in the Huffman tree
-     * @param code: The Huffman code corresponding to the node
+     * @return: The relative size increase over the unlimited Huffman code (0.01 means 1% larger)
+     */
+    return ratioLoss;
+}
+
+void Huffman::assignCanonicalCodes() {
+    /**
+     * Function to assign canonical Huffman codes from the code lengths: codes of the same
+     * length are consecutive integers in symbol order, and every length starts right after
+     * the (shifted) last code of the previous length. Encoder and decoder can therefore
+     * rebuild identical codes from the lengths alone.
      * 
      * @return: None
      */
-    if (!node) return;
-    if (!node->left && !node->right) {
-        #pragma omp critical
-        {
-            huffmanCodes[node->ch] = code;
-            reverseCodes[code] = node->ch;
-        }
-        return;
+    uint32_t lengthCount[MAX_CODE_LENGTH + 1] = {0};
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        lengthCount[codeLengths[symbol]]++;
+    }
+    lengthCount[0] = 0;
+
+    uint64_t nextCode[MAX_CODE_LENGTH + 1] = {0};
+    uint64_t code = 0;
+    for (unsigned length = 1; length <= MAX_CODE_LENGTH; ++length) {
+        code = (code + lengthCount[length - 1]) << 1;
+        nextCode[length] = code;
+    }
+
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        unsigned length = codeLengths[symbol];
+        codes[symbol] = length ? nextCode[length]++ : 0;
     }
-    #pragma omp task shared(huffmanCodes, reverseCodes)
-    generateCodes(node->left, code + "0");
+}
+
+std::vector<uint8_t> Huffman::getCodeLengths() const {
+    /**
+     * Function to retrieve the code length of every byte value, which is all the decoder
+     * needs to rebuild the canonical codes
+     * 
+     * @return: A vector of 256 code lengths (0 for unused byte values)
+     */
+    return std::vector<uint8_t>(codeLengths, codeLengths + 256);
+}
 
-    #pragma omp task shared(huffmanCodes, reverseCodes)
-    generateCodes(node->right, code + "1");
+void Huffman::validateCodeLengths(const std::vector<uint8_t> &lengths) {
+    /**
+     * Function to check that a set of code lengths describes a usable prefix code
+     * 
+     * @param lengths: A vector of 256 code lengths (0 for unused byte values)
+     * 
+     * @return: None (throws std::invalid_argument if the lengths are not valid)
+     */
+    if (lengths.size() != 256) {
+        throw std::invalid_argument("❌ Error: Huffman code lengths must have 256 entries");
+    }
 
-    #pragma omp taskwait
+    // The lengths must describe a prefix code: sum of 2^-length can not exceed 1
+    uint64_t kraftSum = 0;
+    for (uint8_t length : lengths) {
+        if (length > MAX_CODE_LENGTH) {
+            throw std::invalid_argument("❌ Error: Huffman code length exceeds the supported maximum");
+        }
+        if (length) kraftSum += 1ull << (MAX_CODE_LENGTH - length);
+    }
+    if (kraftSum > (1ull << MAX_CODE_LENGTH)) {
+        throw std::invalid_argument("❌ Error: Huffman code lengths do not describe a prefix code");
+    }
 }
 
-std::vector<char> Huffman::compress(const std::vector<char> &data) {
+void Huffman::setCodeLengths(const std::vector<uint8_t> &lengths) {
     /**
-     * Function to compress a given set of data using Huffman encoding
+     * Function to load the code lengths of a previously built tree and derive its canonical codes
+     * 
+     * @param lengths: A vector of 256 code lengths (0 for unused byte values)
+     * 
+     * @return: None
+     */
+    validateCodeLengths(lengths);
+    std::copy(lengths.begin(), lengths.end(), codeLengths);
+    assignCanonicalCodes();
+}
+
+std::vector<uint8_t> Huffman::compress(const std::vector<char> &data) {
+    /**
+     * Function to compress a given set of data using Huffman encoding. The codes are
+     * bit-packed MSB first into a byte buffer through a 64-bit accumulator. The input is
+     * split into blocks of blockSize symbols and the starting bit of every block is
+     * recorded (see getBlocks), so that the blocks can be decoded independently.
      * 
      * @param data: The input data to be compressed
      * 
-     * @return: A vector containing the compressed data
+     * @return: A vector containing the packed bit stream (the last byte is zero padded)
      */
 
     auto start = std::chrono::high_resolution_clock::now();
     int numThreads = omp_get_max_threads();
     printf("\033[1;36m🔵 [OpenMP (Huffman)] Threads used for compress: %d\033[0m\n", numThreads);
 
-    std::vector<std::string> partialEncoded(numThreads);
-    #pragma omp parallel
-    {
-        int tid = omp_get_thread_num();
-        std::stringstream ss;
-        #pragma omp for
-        for (int i = 0; i < static_cast<int>(data.size()); ++i) {
-            ss << huffmanCodes[data[i]];
+    if (interleaved && (blockSize / INTERLEAVED_STREAMS + 1) * MAX_CODE_LENGTH > UINT32_MAX) {
+        throw std::invalid_argument("❌ Error: Huffman block size too large for interleaved sub-streams");
+    }
+    std::vector<uint8_t> compressedData = adaptive ? compressAdaptive(data) : compressStatic(data);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] Compress time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+
+    return compressedData;
+}
+
+std::vector<uint8_t> Huffman::compressStatic(const std::vector<char> &data) {
+    /**
+     * Function to encode every block with the table built by buildTree. Encoding runs in
+     * two parallel passes: the first one sums the code lengths of every block, and after a
+     * prefix sum over those sizes the second one writes all blocks concurrently into one
+     * preallocated buffer.
+     * 
+     * @param data: The input data to be compressed
+     * 
+     * @return: A vector containing the packed bit stream
+     */
+    // Phase 1: the encoded size of every block
+    size_t numBlocks = (data.size() + blockSize - 1) / blockSize;
+    std::vector<uint64_t> blockBits(numBlocks, 0);
+    #pragma omp parallel for schedule(static)
+    for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+        size_t first = static_cast<size_t>(block) * blockSize;
+        size_t last = std::min(first + blockSize, data.size());
+        uint64_t bits = interleaved ? JUMP_TABLE_BITS : 0;
+        for (size_t i = first; i < last; ++i) {
+            bits += codeLengths[static_cast<uint8_t>(data[i])];
         }
-        partialEncoded[tid] = ss.str();
+        blockBits[block] = bits;
     }
 
-    // Concatenate the partial encoded strings
-    std::string encodedStr;
-    for (const auto& part : partialEncoded) {
-        encodedStr += part;
+    // An exclusive prefix sum gives every block its starting bit
+    blocks.assign(numBlocks, CodedBlock{0, 0, false, {}});
+    uint64_t totalBits = 0;
+    for (size_t block = 0; block < numBlocks; ++block) {
+        blocks[block] = CodedBlock{totalBits, block * blockSize, false, {}};
+        totalBits += blockBits[block];
     }
 
-    // Convert the encoded string to a vector of chars
-    std::vector<char> compressedData(encodedStr.begin(), encodedStr.end());
+    // Phase 2: every block writes its codes straight into its bit range of the output
+    std::vector<uint8_t> compressedData((totalBits + 7) / 8, 0);
+    #pragma omp parallel for schedule(static)
+    for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+        size_t first = static_cast<size_t>(block) * blockSize;
+        size_t last = std::min(first + blockSize, data.size());
+        encodeBlock(reinterpret_cast<const uint8_t *>(data.data()) + first, last - first,
+                    compressedData.data(), blocks[block].bitOffset);
+    }
+    return compressedData;
+}
 
-    auto end = std::chrono::high_resolution_clock::now();
-    printf("\033[1;32m🟢 [Timing] Compress time: %lld ms\033[0m\n", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+std::vector<uint8_t> Huffman::compressAdaptive(const std::vector<char> &data) {
+    /**
+     * Function to encode every block with whichever is smallest of: the table built by
+     * buildTree, a table built from the block's own histogram (which costs its 256 code
+     * lengths in the archive), or no coding at all. Blocks start on byte boundaries so
+     * raw blocks can be copied as they are.
+     * 
+     * @param data: The input data to be compressed
+     * 
+     * @return: A vector containing the encoded blocks
+     */
+    const bool useAvx2 = Histogram::hasAvx2();
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    size_t numBlocks = (data.size() + blockSize - 1) / blockSize;
+    blocks.assign(numBlocks, CodedBlock{0, 0, false, {}});
+    std::vector<uint64_t> blockBytes(numBlocks, 0);
+
+    // Phase 1: histogram every block and pick its cheapest encoding
+    #pragma omp parallel for schedule(dynamic)
+    for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+        size_t first = static_cast<size_t>(block) * blockSize;
+        size_t count = std::min(first + blockSize, data.size()) - first;
+        FrequencyTable frequencies = Histogram::countRange(bytes + first, count, useAvx2);
+
+        bool sharedUsable = true;
+        uint64_t sharedBits = interleaved ? JUMP_TABLE_BITS : 0;
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            if (!frequencies[symbol]) continue;
+            if (!codeLengths[symbol]) sharedUsable = false;
+            sharedBits += frequencies[symbol] * codeLengths[symbol];
+        }
+
+        Huffman local;
+        local.maxCodeLength = maxCodeLength;
+        local.buildCodeLengths(frequencies);
+        uint64_t ownBits = BLOCK_TABLE_BITS + (interleaved ? JUMP_TABLE_BITS : 0);
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            ownBits += frequencies[symbol] * local.codeLengths[symbol];
+        }
+        uint64_t rawBits = static_cast<uint64_t>(count) * 8;
+
+        CodedBlock &entry = blocks[block];
+        entry.outputOffset = first;
+        if (sharedUsable && sharedBits <= ownBits && sharedBits < rawBits) {
+            blockBytes[block] = (sharedBits + 7) / 8;
+        } else if (ownBits < rawBits) {
+            entry.codeLengths = local.getCodeLengths();
+            blockBytes[block] = (ownBits - BLOCK_TABLE_BITS + 7) / 8;
+        } else {
+            entry.raw = true;
+            blockBytes[block] = count;
+        }
+    }
+
+    uint64_t totalBytes = 0;
+    for (size_t block = 0; block < numBlocks; ++block) {
+        blocks[block].bitOffset = totalBytes * 8;
+        totalBytes += blockBytes[block];
+    }
 
+    // Phase 2: write every block into its byte range
+    std::vector<uint8_t> compressedData(totalBytes, 0);
+    #pragma omp parallel for schedule(dynamic)
+    for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+        const CodedBlock &entry = blocks[block];
+        size_t first = entry.outputOffset;
+        size_t last = std::min(first + blockSize, data.size());
+        uint8_t *out = compressedData.data() + entry.bitOffset / 8;
+        if (entry.raw) {
+            std::memcpy(out, bytes + first, last - first);
+            continue;
+        }
+        Huffman local;
+        const Huffman *table = this;
+        if (!entry.codeLengths.empty()) {
+            local.setCodeLengths(entry.codeLengths);
+            local.interleaved = interleaved;
+            table = &local;
+        }
+        table->encodeBlock(bytes + first, last - first, compressedData.data(), entry.bitOffset);
+    }
     return compressedData;
 }
 
-std::vector<char> Huffman::uncompress(const std::vector<char> &data, 
-    const std::unordered_map<std::string, char>* externalReverseCodes) {
+void Huffman::encodeBlock(const uint8_t *symbols, size_t count, uint8_t *out, uint64_t bitOffset) const {
+    /**
+     * Function to write the codes of one block into its bit range of a preallocated buffer.
+     * In interleaved mode the block is cut into INTERLEAVED_STREAMS consecutive segments,
+     * each one a sub-stream of its own, and it starts with a jump table holding the bit
+     * length of every sub-stream but the last one.
+     * 
+     * @param symbols: The symbols of the block
+     * @param count: The number of symbols in the block
+     * @param out: The zero-filled output buffer
+     * @param bitOffset: The bit where the block starts
+     * 
+     * @return: None
+     */
+    OffsetBitWriter writer(out, bitOffset);
+    if (interleaved) {
+        size_t segment = (count + INTERLEAVED_STREAMS - 1) / INTERLEAVED_STREAMS;
+        for (unsigned stream = 0; stream + 1 < INTERLEAVED_STREAMS; ++stream) {
+            size_t first = std::min(stream * segment, count);
+            size_t last = std::min(first + segment, count);
+            uint64_t bits = 0;
+            for (size_t i = first; i < last; ++i) {
+                bits += codeLengths[symbols[i]];
+            }
+            writer.write(bits, JUMP_ENTRY_BITS);
+        }
+    }
+
+    // The sub-streams follow each other in symbol order, so one writer lays them all out
+    for (size_t i = 0; i < count; ++i) {
+        writer.write(codes[symbols[i]], codeLengths[symbols[i]]);
+    }
+    writer.flush();
+}
+
+bool Huffman::decodeSlowSymbol(BitReader &reader, char &symbol) const {
     /**
-     * Function to decompress Huffman encoded data
+     * Function to decode a symbol whose code does not fit the first-level table. The reader
+     * is refilled before and after, so it always holds at least 56 bits on return.
      * 
-     * @param data: The compressed input data
-     * @param externalReverseCodes: A pointer to an external Huffman table, if provided
+     * @param reader: The reader positioned at the code
+     * @param symbol: Where the decoded symbol is written
      * 
-     * @return: A vector containing the decompressed data
+     * @return: true if a symbol was decoded, false if the stream holds an invalid code
+     */
+    reader.refill();
+    const DecodeEntry &entry = decodeTable[reader.peek(TABLE_BITS)];
+    if (entry.length) {
+        symbol = static_cast<char>(entry.value);
+        reader.consume(entry.length);
+        reader.refill();
+        return true;
+    }
+    if (entry.subBits) {
+        uint64_t subIndex = reader.peek(TABLE_BITS + entry.subBits) & ((1u << entry.subBits) - 1);
+        const DecodeEntry &subEntry = decodeTable[entry.value + subIndex];
+        if (subEntry.length) {
+            symbol = static_cast<char>(subEntry.value);
+            reader.consume(TABLE_BITS + subEntry.length);
+            reader.refill();
+            return true;
+        }
+    }
+
+    for (unsigned length = TABLE_BITS + MAX_SUB_TABLE_BITS + 1; length <= MAX_CODE_LENGTH; ++length) {
+        uint64_t offset = reader.peek(length) - firstCode[length];
+        if (offset < lengthCount[length]) {
+            symbol = static_cast<char>(sortedSymbols[firstIndex[length] + offset]);
+            reader.consume(length);
+            reader.refill();
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool Huffman::decodeSymbol(BitReader &reader, char &symbol) const {
+    /**
+     * Function to decode a single symbol through the first-level table. The reader must
+     * hold at least TABLE_BITS bits; longer codes go through decodeSlowSymbol.
+     * 
+     * @param reader: The reader positioned at the code
+     * @param symbol: Where the decoded symbol is written
+     * 
+     * @return: true if a symbol was decoded, false if the stream holds an invalid code
+     */
+    const DecodeEntry &entry = decodeTable[reader.peek(TABLE_BITS)];
+    if (entry.length) {
+        symbol = static_cast<char>(entry.value);
+        reader.consume(entry.length);
+        return true;
+    }
+    return decodeSlowSymbol(reader, symbol);
+}
+
+bool Huffman::decodeInterleavedBlock(const std::vector<uint8_t> &data, uint64_t bitOffset, char *output, size_t count) const {
+    /**
+     * Function to decode a block written as interleaved sub-streams. The readers of all the
+     * sub-streams advance in the same loop, so their independent lookups can overlap in the
+     * CPU pipeline instead of waiting on one another.
+     * 
+     * @param data: The packed bit stream produced by compress
+     * @param bitOffset: The bit where the block (its jump table) starts
+     * @param output: Where the decoded symbols are written
+     * @param count: The number of symbols to decode
+     * 
+     * @return: true if all the symbols were decoded, false if the stream is invalid
+     */
+    // An empty block has no symbols and no jump table to read
+    if (count == 0) return true;
+    BitReader header(data.data(), data.size(), bitOffset);
+    uint64_t streamStart[INTERLEAVED_STREAMS];
+    streamStart[0] = bitOffset + JUMP_TABLE_BITS;
+    for (unsigned stream = 1; stream < INTERLEAVED_STREAMS; ++stream) {
+        streamStart[stream] = streamStart[stream - 1] + header.read(JUMP_ENTRY_BITS);
+    }
+    if (streamStart[INTERLEAVED_STREAMS - 1] > data.size() * 8ull) return false;
+
+    size_t segment = (count + INTERLEAVED_STREAMS - 1) / INTERLEAVED_STREAMS;
+    size_t segmentCount[INTERLEAVED_STREAMS];
+    for (unsigned stream = 0; stream < INTERLEAVED_STREAMS; ++stream) {
+        size_t first = std::min(stream * segment, count);
+        segmentCount[stream] = std::min(first + segment, count) - first;
+    }
+
+    BitReader r0(data.data(), data.size(), streamStart[0]);
+    BitReader r1(data.data(), data.size(), streamStart[1]);
+    BitReader r2(data.data(), data.size(), streamStart[2]);
+    BitReader r3(data.data(), data.size(), streamStart[3]);
+    char *o0 = output, *o1 = o0 + segmentCount[0], *o2 = o1 + segmentCount[1], *o3 = o2 + segmentCount[2];
+
+    // A refill leaves at least 56 bits, enough for SYMBOLS_PER_REFILL first-level codes of
+    // TABLE_BITS each. The last segment is the shortest one, so up to its size all four
+    // streams still have symbols.
+    constexpr unsigned SYMBOLS_PER_REFILL = 56 / TABLE_BITS;
+    bool valid = true;
+    size_t i = 0;
+    for (; i + SYMBOLS_PER_REFILL <= segmentCount[3]; i += SYMBOLS_PER_REFILL) {
+        r0.refill();
+        r1.refill();
+        r2.refill();
+        r3.refill();
+        for (unsigned k = 0; k < SYMBOLS_PER_REFILL; ++k) {
+            valid &= decodeSymbol(r0, o0[i + k]);
+            valid &= decodeSymbol(r1, o1[i + k]);
+            valid &= decodeSymbol(r2, o2[i + k]);
+            valid &= decodeSymbol(r3, o3[i + k]);
+        }
+    }
+
+    BitReader *readers[INTERLEAVED_STREAMS] = {&r0, &r1, &r2, &r3};
+    char *outputs[INTERLEAVED_STREAMS] = {o0, o1, o2, o3};
+    for (unsigned stream = 0; stream < INTERLEAVED_STREAMS; ++stream) {
+        for (size_t j = i; j < segmentCount[stream]; ++j) {
+            readers[stream]->refill();
+            valid &= decodeSymbol(*readers[stream], outputs[stream][j]);
+        }
+    }
+    return valid;
+}
+
+bool Huffman::decodeBlock(const std::vector<uint8_t> &data, uint64_t bitOffset, char *output, size_t count) const {
+    /**
+     * Function to decode `count` symbols starting at a given bit of the stream, resolving a
+     * whole symbol per table lookup
+     * 
+     * @param data: The packed bit stream produced by compress
+     * @param bitOffset: The bit where the first code starts
+     * @param output: Where the decoded symbols are written
+     * @param count: The number of symbols to decode
+     * 
+     * @return: true if all the symbols were decoded, false if the stream holds an invalid code
+     */
+    BitReader reader(data.data(), data.size(), bitOffset);
+    const unsigned maxTableBits = TABLE_BITS + MAX_SUB_TABLE_BITS;
+    size_t written = 0;
+    while (written < count) {
+        reader.refill();
+
+        // Fast path: every code resolvable through the tables is at most maxTableBits long
+        while (reader.available() >= maxTableBits && written < count) {
+            const DecodeEntry &entry = decodeTable[reader.peek(TABLE_BITS)];
+            if (entry.length) {
+                output[written++] = static_cast<char>(entry.value);
+                reader.consume(entry.length);
+                continue;
+            }
+            if (!entry.subBits) break;
+            uint64_t subIndex = reader.peek(TABLE_BITS + entry.subBits) & ((1u << entry.subBits) - 1);
+            const DecodeEntry &subEntry = decodeTable[entry.value + subIndex];
+            if (!subEntry.length) break;
+            output[written++] = static_cast<char>(subEntry.value);
+            reader.consume(TABLE_BITS + subEntry.length);
+        }
+        if (written >= count || reader.available() < maxTableBits) continue;
+
+        // Slow path: codes too long for the tables are matched canonically, one length at a time
+        reader.refill();
+        bool found = false;
+        for (unsigned length = maxTableBits + 1; length <= MAX_CODE_LENGTH && !found; ++length) {
+            uint64_t offset = reader.peek(length) - firstCode[length];
+            if (offset < lengthCount[length]) {
+                output[written++] = static_cast<char>(sortedSymbols[firstIndex[length] + offset]);
+                reader.consume(length);
+                found = true;
+            }
+        }
+        if (!found) return false;
+    }
+    return true;
+}
+
+template <unsigned MaxBits, unsigned Streams>
+bool Huffman::decodeBoundedBlock(const std::vector<uint8_t> &data, uint64_t bitOffset, char *output, size_t count) const {
+    /**
+     * Function to decode a block whose codes are all at most MaxBits long. The flat table
+     * resolves every code in one lookup, so the inner loop has no second level, no canonical
+     * fallback and no validity branch, and a refill is followed by a batch of symbols whose
+     * size is fixed at compile time. Plain blocks use one reader, interleaved ones advance
+     * the readers of all the sub-streams in the same loop.
+     * 
+     * @param data: The packed bit stream produced by compress
+     * @param bitOffset: The bit where the block (its jump table, if interleaved) starts
+     * @param output: Where the decoded symbols are written
+     * @param count: The number of symbols to decode
+     * 
+     * @return: true if all the symbols were decoded, false if the jump table is invalid
+     */
+    static_assert(Streams == 1 || Streams == INTERLEAVED_STREAMS, "Blocks are either plain or fully interleaved");
+    // A refill leaves at least 56 bits, enough for SYMBOLS_PER_REFILL codes of MaxBits each
+    constexpr unsigned SYMBOLS_PER_REFILL = 56 / MaxBits;
+    const uint16_t *table = flatTable.data();
+    auto decodeOne = [table](BitReader &reader, char &symbol) {
+        uint16_t entry = table[reader.peek(MaxBits)];
+        symbol = static_cast<char>(entry);
+        reader.consume(entry >> 8);
+    };
+
+    if constexpr (Streams == 1) {
+        BitReader reader(data.data(), data.size(), bitOffset);
+        size_t i = 0;
+        for (; i + SYMBOLS_PER_REFILL <= count; i += SYMBOLS_PER_REFILL) {
+            reader.refill();
+            for (unsigned k = 0; k < SYMBOLS_PER_REFILL; ++k) decodeOne(reader, output[i + k]);
+        }
+        reader.refill();
+        for (; i < count; ++i) decodeOne(reader, output[i]);
+        return true;
+    } else {
+        if (count == 0) return true;
+        BitReader header(data.data(), data.size(), bitOffset);
+        uint64_t streamStart[Streams];
+        streamStart[0] = bitOffset + JUMP_TABLE_BITS;
+        for (unsigned stream = 1; stream < Streams; ++stream) {
+            streamStart[stream] = streamStart[stream - 1] + header.read(JUMP_ENTRY_BITS);
+        }
+        if (streamStart[Streams - 1] > data.size() * 8ull) return false;
+
+        size_t segment = (count + Streams - 1) / Streams;
+        size_t segmentCount[Streams];
+        for (unsigned stream = 0; stream < Streams; ++stream) {
+            size_t first = std::min(stream * segment, count);
+            segmentCount[stream] = std::min(first + segment, count) - first;
+        }
+
+        // Separate locals rather than an array keep the readers in registers
+        BitReader r0(data.data(), data.size(), streamStart[0]);
+        BitReader r1(data.data(), data.size(), streamStart[1]);
+        BitReader r2(data.data(), data.size(), streamStart[2]);
+        BitReader r3(data.data(), data.size(), streamStart[3]);
+        char *o0 = output, *o1 = o0 + segmentCount[0], *o2 = o1 + segmentCount[1], *o3 = o2 + segmentCount[2];
+
+        // The last segment is the shortest one, so up to its size all four streams still have symbols
+        size_t i = 0;
+        for (; i + SYMBOLS_PER_REFILL <= segmentCount[3]; i += SYMBOLS_PER_REFILL) {
+            r0.refill();
+            r1.refill();
+            r2.refill();
+            r3.refill();
+            for (unsigned k = 0; k < SYMBOLS_PER_REFILL; ++k) {
+                decodeOne(r0, o0[i + k]);
+                decodeOne(r1, o1[i + k]);
+                decodeOne(r2, o2[i + k]);
+                decodeOne(r3, o3[i + k]);
+            }
+        }
+
+        BitReader *readers[Streams] = {&r0, &r1, &r2, &r3};
+        char *outputs[Streams] = {o0, o1, o2, o3};
+        for (unsigned stream = 0; stream < Streams; ++stream) {
+            for (size_t j = i; j < segmentCount[stream]; ++j) {
+                readers[stream]->refill();
+                decodeOne(*readers[stream], outputs[stream][j]);
+            }
+        }
+        return true;
+    }
+}
+
+bool Huffman::decodeAnyBlock(const std::vector<uint8_t> &data, uint64_t bitOffset, char *output, size_t count) const {
+    /**
+     * Function to decode a block with the decoder specialized for the longest code of the
+     * table, falling back to the two-level decoder when codes are longer than every bound
+     * 
+     * @param data: The packed bit stream produced by compress
+     * @param bitOffset: The bit where the block starts
+     * @param output: Where the decoded symbols are written
+     * @param count: The number of symbols to decode
+     * 
+     * @return: true if all the symbols were decoded, false if the stream is invalid
+     */
+    switch (flatBits) {
+        case 8:
+            return interleaved ? decodeBoundedBlock<8, INTERLEAVED_STREAMS>(data, bitOffset, output, count)
+                               : decodeBoundedBlock<8, 1>(data, bitOffset, output, count);
+        case 11:
+            return interleaved ? decodeBoundedBlock<11, INTERLEAVED_STREAMS>(data, bitOffset, output, count)
+                               : decodeBoundedBlock<11, 1>(data, bitOffset, output, count);
+        case 12:
+            return interleaved ? decodeBoundedBlock<12, INTERLEAVED_STREAMS>(data, bitOffset, output, count)
+                               : decodeBoundedBlock<12, 1>(data, bitOffset, output, count);
+        case 15:
+            return interleaved ? decodeBoundedBlock<15, INTERLEAVED_STREAMS>(data, bitOffset, output, count)
+                               : decodeBoundedBlock<15, 1>(data, bitOffset, output, count);
+        default:
+            return interleaved ? decodeInterleavedBlock(data, bitOffset, output, count)
+                               : decodeBlock(data, bitOffset, output, count);
+    }
+}
+
+std::vector<char> Huffman::uncompress(const std::vector<uint8_t> &data, size_t outputSize,
+    const std::vector<uint8_t>* externalCodeLengths, const std::vector<CodedBlock>* externalBlocks) {
+    /**
+     * Function to decompress Huffman encoded data. The blocks are decoded in parallel with
+     * OpenMP, each one straight into its place in the preallocated output, using the stream
+     * table, its own table, or a plain copy for stored blocks.
+     * 
+     * @param data: The packed bit stream produced by compress
+     * @param outputSize: The number of symbols to decode
+     * @param externalCodeLengths: A pointer to the code lengths of an external Huffman table, if provided
+     * @param externalBlocks: A pointer to an external block index, if provided
+     * 
+     * @return: A vector containing the decompressed data (empty if the stream is invalid)
      */
     auto start = std::chrono::high_resolution_clock::now();
-    const std::unordered_map<std::string, char>& codesToUse = 
-        (externalReverseCodes) ? *externalReverseCodes : reverseCodes;
 
-    std::string encodedStr(data.begin(), data.end());
-    std::string decodedStr;
-    std::string currentCode;
+    if (externalCodeLengths) {
+        setCodeLengths(*externalCodeLengths);
+    }
+    if (externalBlocks) {
+        setBlocks(*externalBlocks);
+    }
+    buildDecodeTable();
 
-    for (char bit : encodedStr) {
-        currentCode += bit;
-        if (codesToUse.count(currentCode)) {
-            decodedStr += codesToUse.at(currentCode);
-            currentCode.clear();
+    // Without an index the whole stream is a single block
+    std::vector<CodedBlock> index = blocks.empty() ? std::vector<CodedBlock>{CodedBlock{0, 0, false, {}}} : blocks;
+    for (size_t block = 0; block < index.size(); ++block) {
+        uint64_t nextOutput = block + 1 < index.size() ? index[block + 1].outputOffset : outputSize;
+        if (index[block].outputOffset > nextOutput || index[block].bitOffset > data.size() * 8ull) {
+            throw std::invalid_argument("❌ Error: Invalid Huffman block index");
         }
     }
 
+    for (size_t block = 0; block < index.size(); ++block) {
+        uint64_t nextOutput = block + 1 < index.size() ? index[block + 1].outputOffset : outputSize;
+        if (index[block].raw && (index[block].bitOffset % 8 != 0 ||
+                                 index[block].bitOffset / 8 + (nextOutput - index[block].outputOffset) > data.size())) {
+            throw std::invalid_argument("❌ Error: Invalid raw Huffman block");
+        }
+    }
+
+    std::vector<char> decoded(outputSize);
+    bool valid = true;
+    #pragma omp parallel for schedule(dynamic) reduction(&& : valid)
+    for (long long block = 0; block < static_cast<long long>(index.size()); ++block) {
+        const CodedBlock &entry = index[block];
+        uint64_t first = entry.outputOffset;
+        uint64_t last = block + 1 < static_cast<long long>(index.size()) ? index[block + 1].outputOffset : outputSize;
+        if (entry.raw) {
+            // Stored blocks are copied straight through
+            std::memcpy(decoded.data() + first, data.data() + entry.bitOffset / 8, last - first);
+        } else if (!entry.codeLengths.empty()) {
+            Huffman local;
+            local.setCodeLengths(entry.codeLengths);
+            local.buildDecodeTable();
+            local.interleaved = interleaved;
+            valid = local.decodeAnyBlock(data, entry.bitOffset, decoded.data() + first, last - first) && valid;
+        } else {
+            valid = decodeAnyBlock(data, entry.bitOffset, decoded.data() + first, last - first) && valid;
+        }
+    }
+    if (!valid) {
+        std::cerr << "❌ Error: Invalid Huffman code in compressed stream\n" << std::endl;
+        decoded.clear();
+    }
+
     auto end = std::chrono::high_resolution_clock::now();
-    printf("\033[1;32m🟢 [Timing] Uncompress time: %lld ms\033[0m\n", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
-    return std::vector<char>(decodedStr.begin(), decodedStr.end());
+    printf("\033[1;32m🟢 [Timing] Uncompress time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+    return decoded;
+}
+
+std::vector<CodedBlock> Huffman::getBlocks() const {
+    /**
+     * Function to retrieve the block index of the last compressed stream
+     * 
+     * @return: The bit offset and output offset of every block
+     */
+    return blocks;
+}
+
+void Huffman::setBlocks(const std::vector<CodedBlock> &blockIndex) {
+    /**
+     * Function to load the block index of a previously compressed stream
+     * 
+     * @param blockIndex: The bit offset and output offset of every block
+     * 
+     * @return: None
+     */
+    for (size_t block = 1; block < blockIndex.size(); ++block) {
+        if (blockIndex[block].bitOffset < blockIndex[block - 1].bitOffset ||
+            blockIndex[block].outputOffset < blockIndex[block - 1].outputOffset) {
+            throw std::invalid_argument("❌ Error: Huffman block index must be in stream order");
+        }
+    }
+    for (const CodedBlock &block : blockIndex) {
+        if (!block.codeLengths.empty()) validateCodeLengths(block.codeLengths);
+    }
+    blocks = blockIndex;
+}
+
+void Huffman::setAdaptive(bool enabled) {
+    /**
+     * Function to choose between one table for the whole stream and a per-block choice of
+     * the stream table, a table of the block's own, or storing the block uncompressed
+     * 
+     * @param enabled: Whether compress should pick the encoding of every block
+     * 
+     * @return: None
+     */
+    adaptive = enabled;
+}
+
+void Huffman::setInterleaved(bool enabled) {
+    /**
+     * Function to choose whether every block is written as INTERLEAVED_STREAMS sub-streams
+     * behind a jump table, which lets the decoder work on several codes at once
+     * 
+     * @param enabled: Whether blocks are split into interleaved sub-streams
+     * 
+     * @return: None
+     */
+    interleaved = enabled;
 }
 
-std::unordered_map<std::string, char> Huffman::getReverseCodes() {
+void Huffman::setBlockSize(size_t size) {
     /**
-     * Function to retrieve the reverse Huffman table
+     * Function to set how many symbols each independently decodable block holds
      * 
-     * @return: A map containing Huffman codes and their corresponding characters
+     * @param size: The number of symbols per block
+     * 
+     * @return: None
      */
-    return reverseCodes;
-}
\ No newline at end of file
+    if (size == 0) {
+        throw std::invalid_argument("❌ Error: Huffman block size must be greater than 0");
+    }
+    blockSize = size;
+}
+
+void Huffman::buildDecodeTable() {
+    /**
+     * Function to build the lookup tables used by uncompress. The first level is indexed by
+     * the next TABLE_BITS bits of the stream and resolves every code up to that length in one
+     * lookup. Longer codes point to a second-level table indexed by the following bits, and
+     * codes that do not fit in either level are decoded canonically from `firstCode`. When
+     * the longest code fits one of FLAT_TABLE_BITS, a flat table of that width is built too.
+     * 
+     * @return: None
+     */
+    const unsigned primarySize = 1u << TABLE_BITS;
+    decodeTable.assign(primarySize, DecodeEntry{0, 0, 0});
+
+    // Canonical ranges per length: symbols sorted by (length, value) and the first code of each length
+    std::fill(lengthCount, lengthCount + MAX_CODE_LENGTH + 1, 0);
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        if (codeLengths[symbol]) lengthCount[codeLengths[symbol]]++;
+    }
+    uint32_t index = 0;
+    for (unsigned length = 1; length <= MAX_CODE_LENGTH; ++length) {
+        firstIndex[length] = index;
+        index += lengthCount[length];
+    }
+    sortedSymbols.assign(index, 0);
+    std::fill(firstCode, firstCode + MAX_CODE_LENGTH + 1, 0);
+    uint32_t nextIndex[MAX_CODE_LENGTH + 1];
+    std::copy(firstIndex, firstIndex + MAX_CODE_LENGTH + 1, nextIndex);
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        unsigned length = codeLengths[symbol];
+        if (!length) continue;
+        if (nextIndex[length] == firstIndex[length]) firstCode[length] = codes[symbol];
+        sortedSymbols[nextIndex[length]++] = static_cast<uint8_t>(symbol);
+    }
+
+    // First level entries, and the width of the second-level table under each prefix
+    std::vector<uint8_t> subBits(primarySize, 0);
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        unsigned length = codeLengths[symbol];
+        if (length == 0) continue;
+        uint64_t code = codes[symbol];
+        if (length <= TABLE_BITS) {
+            uint64_t first = code << (TABLE_BITS - length);
+            uint64_t count = 1ull << (TABLE_BITS - length);
+            for (uint64_t i = 0; i < count; ++i) {
+                decodeTable[first + i] = DecodeEntry{static_cast<uint32_t>(symbol), static_cast<uint8_t>(length), 0};
+            }
+            continue;
+        }
+        uint64_t prefix = code >> (length - TABLE_BITS);
+        unsigned width = std::min<unsigned>(length - TABLE_BITS, MAX_SUB_TABLE_BITS);
+        subBits[prefix] = std::max<uint8_t>(subBits[prefix], static_cast<uint8_t>(width));
+    }
+
+    // Second level tables are appended after the first level
+    for (unsigned prefix = 0; prefix < primarySize; ++prefix) {
+        if (!subBits[prefix]) continue;
+        decodeTable[prefix] = DecodeEntry{static_cast<uint32_t>(decodeTable.size()), 0, subBits[prefix]};
+        decodeTable.resize(decodeTable.size() + (1ull << subBits[prefix]), DecodeEntry{0, 0, 0});
+    }
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        unsigned length = codeLengths[symbol];
+        if (length <= TABLE_BITS || length > TABLE_BITS + MAX_SUB_TABLE_BITS) continue;
+        uint64_t code = codes[symbol];
+        unsigned rest = length - TABLE_BITS;
+        const DecodeEntry &parent = decodeTable[code >> rest];
+        uint64_t first = parent.value + ((code & ((1ull << rest) - 1)) << (parent.subBits - rest));
+        uint64_t count = 1ull << (parent.subBits - rest);
+        for (uint64_t i = 0; i < count; ++i) {
+            decodeTable[first + i] = DecodeEntry{static_cast<uint32_t>(symbol), static_cast<uint8_t>(rest), 0};
+        }
+    }
+
+    // Flat table for the smallest bound that holds the longest code. Only complete codes get
+    // one: every index then decodes to a symbol, so the bounded decoders never meet an invalid code.
+    unsigned longest = *std::max_element(codeLengths, codeLengths + 256);
+    flatBits = 0;
+    flatTable.clear();
+    for (unsigned bits : FLAT_TABLE_BITS) {
+        if (longest <= bits) {
+            flatBits = bits;
+            break;
+        }
+    }
+    uint64_t kraftSum = 0;
+    for (int symbol = 0; symbol < 256 && flatBits; ++symbol) {
+        if (codeLengths[symbol]) kraftSum += 1ull << (flatBits - codeLengths[symbol]);
+    }
+    if (kraftSum != (1ull << flatBits)) {
+        flatBits = 0;
+        return;
+    }
+    flatTable.assign(1u << flatBits, 0);
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        unsigned length = codeLengths[symbol];
+        if (length == 0) continue;
+        uint64_t first = codes[symbol] << (flatBits - length);
+        uint64_t count = 1ull << (flatBits - length);
+        for (uint64_t i = 0; i < count; ++i) {
+            flatTable[first + i] = static_cast<uint16_t>(symbol | (length << 8));
+        }
+    }
+}
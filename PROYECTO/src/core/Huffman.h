@@ -4,37 +4,98 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <queue>
 #include <unordered_map>
+#include <cstdint>
+#include "EntropyCoder.h"
+#include "../helpers/Histogram.h"
 
-class Huffman {
+class BitReader;
+
+class Huffman : public EntropyCoder {
 private:
-    struct Node {
-        char ch;
-        int freq;
-        Node *left, *right;
-        Node(char c, int f, Node *l = nullptr, Node *r = nullptr) : ch(c), freq(f), left(l), right(r) {}
+    friend class HuffmanStreamEncoder;  // Code blocks one at a time with their own tables
+    friend class HuffmanStreamDecoder;
+
+    struct TreeNode {
+        uint64_t freq;
+        uint16_t parent;  // Index of the parent node in `tree`
     };
 
-    struct Compare {
-        bool operator()(Node *l, Node *r) {
-            return l->freq > r->freq;
-        }
+    struct DecodeEntry {
+        uint32_t value;   // Decoded symbol, or offset of the second-level table
+        uint8_t length;   // Code bits consumed by this entry, 0 if it is not a symbol
+        uint8_t subBits;  // Index width of the second-level table, 0 if there is none
     };
-    std::unordered_map<char, std::string> huffmanCodes;
-    std::unordered_map<std::string, char> reverseCodes;
-    Node *root;
+
+    static constexpr unsigned TABLE_BITS = 11;
+    static constexpr unsigned MAX_SUB_TABLE_BITS = 13;
+    static constexpr unsigned MAX_CODE_LENGTH = 56;  // Widest code the bit reader can peek at once
+    static constexpr unsigned MAX_TREE_NODES = 2 * 256 - 1;
+    static constexpr uint64_t BLOCK_TABLE_BITS = 256 * 8;  // Archive cost of a block's own code lengths
+    static constexpr unsigned INTERLEAVED_STREAMS = 4;
+    static constexpr unsigned JUMP_ENTRY_BITS = 32;      // Bit length of one sub-stream in the jump table
+    static constexpr uint64_t JUMP_TABLE_BITS = (INTERLEAVED_STREAMS - 1) * JUMP_ENTRY_BITS;
+    static constexpr unsigned FLAT_TABLE_BITS[] = {8, 11, 12, 15};  // Code length bounds with a specialized decoder
+
+    TreeNode tree[MAX_TREE_NODES];  // Leaves first (sorted by frequency), then internal nodes
+
+    uint64_t codes[256];        // Code bits of every byte value, right aligned
+    uint8_t codeLengths[256];   // Code length of every byte value, 0 if unused
+    std::vector<DecodeEntry> decodeTable;
+    // Single-level table for complete codes of at most flatBits bits: symbol | length << 8
+    std::vector<uint16_t> flatTable;
+    unsigned flatBits;  // One of FLAT_TABLE_BITS, 0 if the code is incomplete or its longest code fits none
+    // Canonical decoding state for codes longer than both table levels
+    std::vector<uint8_t> sortedSymbols;
+    uint64_t firstCode[MAX_CODE_LENGTH + 1];
+    uint32_t firstIndex[MAX_CODE_LENGTH + 1];
+    uint32_t lengthCount[MAX_CODE_LENGTH + 1];
+    unsigned maxCodeLength;  // 0 means limited only by MAX_CODE_LENGTH
+    double ratioLoss;
+    size_t blockSize;
+    std::vector<CodedBlock> blocks;
+    bool adaptive;
+    bool interleaved;
+
+    void buildCodeLengths(const FrequencyTable &frequencies);
+    void generateCodeLengths(const FrequencyTable &frequencies);
+    void limitCodeLengths(const FrequencyTable &frequencies, unsigned maxLength);
+    void assignCanonicalCodes();
+    void buildDecodeTable();
+    std::vector<uint8_t> compressStatic(const std::vector<char> &data);
+    std::vector<uint8_t> compressAdaptive(const std::vector<char> &data);
+    void encodeBlock(const uint8_t *symbols, size_t count, uint8_t *out, uint64_t bitOffset) const;
+    static void validateCodeLengths(const std::vector<uint8_t> &lengths);
+    bool decodeSlowSymbol(BitReader &reader, char &symbol) const;
+    bool decodeSymbol(BitReader &reader, char &symbol) const;
+    bool decodeInterleavedBlock(const std::vector<uint8_t> &data, uint64_t bitOffset, char *output, size_t count) const;
+    bool decodeBlock(const std::vector<uint8_t> &data, uint64_t bitOffset, char *output, size_t count) const;
+    template <unsigned MaxBits, unsigned Streams>
+    bool decodeBoundedBlock(const std::vector<uint8_t> &data, uint64_t bitOffset, char *output, size_t count) const;
+    bool decodeAnyBlock(const std::vector<uint8_t> &data, uint64_t bitOffset, char *output, size_t count) const;
 public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1 << 17;
 
-    void buildTree(const std::unordered_map<char, int> &freqMap);
-    void generateCodes(Node *node, const std::string &code);
-    void deleteTree(Node *node);
-    std::unordered_map<std::string, char> getReverseCodes();
+    static std::vector<uint8_t> limitedCodeLengths(const FrequencyTable &frequencies, unsigned maxLength);
+    std::string getName() const override;
+    void buildModel(const FrequencyTable &frequencies) override;
+    std::vector<uint8_t> getTable() const override;
+    void setTable(const std::vector<uint8_t> &table) override;
+    void buildTree(const FrequencyTable &frequencies);
+    std::vector<uint8_t> getCodeLengths() const;
+    void setCodeLengths(const std::vector<uint8_t> &lengths);
+    void setMaxCodeLength(unsigned maxLength);
+    double getRatioLoss() const;
+    std::vector<CodedBlock> getBlocks() const override;
+    void setBlocks(const std::vector<CodedBlock> &blockIndex) override;
+    void setBlockSize(size_t size) override;
+    void setAdaptive(bool enabled);
+    void setInterleaved(bool enabled);
     Huffman();
-    ~Huffman();
-    std::vector<char> compress(const std::vector<char> &data);
-    std::vector<char> uncompress(const std::vector<char> &data, 
-        const std::unordered_map<std::string, char>* externalReverseCodes = nullptr);    
+    std::vector<uint8_t> compress(const std::vector<char> &data) override;
+    std::vector<char> uncompress(const std::vector<uint8_t> &data, size_t outputSize,
+        const std::vector<uint8_t>* externalCodeLengths = nullptr,
+        const std::vector<CodedBlock>* externalBlocks = nullptr) override;
 };
 
 #endif
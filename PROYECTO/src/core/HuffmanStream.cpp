@@ -0,0 +1,339 @@
+#include "HuffmanStream.h"
+#include "../helpers/Histogram.h"
+#include <omp.h>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+static constexpr size_t WORD_BYTES = 4;  // Width of the block size, symbol counts and payload sizes
+
+HuffmanStreamEncoder::HuffmanStreamEncoder(size_t blockSize, unsigned maxCodeLength)
+    : out(nullptr), blockSize(blockSize), maxCodeLength(maxCodeLength), inputBytes(0), outputBytes(0), elapsedMs(0) {
+    /**
+     * Constructor for the HuffmanStreamEncoder class
+     *
+     * @param blockSize: The number of symbols of every block (1 to MAX_BLOCK_SIZE)
+     * @param maxCodeLength: The cap on the code lengths of every table, or 0 for no cap
+     *
+     * @return: None
+     */
+    if (blockSize == 0 || blockSize > MAX_BLOCK_SIZE) {
+        throw std::invalid_argument("❌ Error: Streaming Huffman block size must be between 1 and " + std::to_string(MAX_BLOCK_SIZE));
+    }
+    Huffman().setMaxCodeLength(maxCodeLength);
+}
+
+void HuffmanStreamEncoder::writeBytes(const void *data, size_t size) {
+    /**
+     * Function to append bytes to the output stream
+     *
+     * @param data: The bytes to write
+     * @param size: The number of bytes
+     *
+     * @return: None (throws std::invalid_argument if the stream fails)
+     */
+    out->write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    if (!*out) {
+        throw std::invalid_argument("❌ Error: Could not write the Huffman stream");
+    }
+    outputBytes += size;
+}
+
+void HuffmanStreamEncoder::begin(std::ostream &output) {
+    /**
+     * Function to start a new stream, writing its header
+     *
+     * @param output: Where the coded stream is written
+     *
+     * @return: None
+     */
+    out = &output;
+    pending.clear();
+    pending.reserve(blockSize * omp_get_max_threads());
+    previousTable.clear();
+    inputBytes = 0;
+    outputBytes = 0;
+    elapsedMs = 0;
+    uint8_t header[WORD_BYTES];
+    for (size_t i = 0; i < WORD_BYTES; ++i) header[i] = static_cast<uint8_t>(blockSize >> (8 * i));
+    writeBytes(header, WORD_BYTES);
+}
+
+void HuffmanStreamEncoder::push(const char *data, size_t size) {
+    /**
+     * Function to add input to the stream. Whenever a batch of one block per thread is
+     * complete it is coded and written, so at most one batch is held in memory.
+     *
+     * @param data: The next bytes of the input
+     * @param size: The number of bytes
+     *
+     * @return: None
+     */
+    if (!out) {
+        throw std::invalid_argument("❌ Error: Streaming Huffman encoder used before begin");
+    }
+    size_t batchBytes = blockSize * omp_get_max_threads();
+    inputBytes += size;
+    while (size > 0) {
+        size_t take = std::min(size, batchBytes - pending.size());
+        pending.insert(pending.end(), data, data + take);
+        data += take;
+        size -= take;
+        if (pending.size() == batchBytes) flushBatch();
+    }
+}
+
+void HuffmanStreamEncoder::push(const std::vector<char> &chunk) {
+    /**
+     * Function to add a chunk of input to the stream (see push above)
+     *
+     * @param chunk: The next bytes of the input
+     *
+     * @return: None
+     */
+    push(chunk.data(), chunk.size());
+}
+
+void HuffmanStreamEncoder::flushBatch() {
+    /**
+     * Function to code and write the pending blocks. The histograms, own tables and payloads
+     * are built in parallel; only the choice between the previous table, a new one and a raw
+     * copy runs in block order, since each block may reuse the table chosen before it.
+     *
+     * @return: None
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    const bool useAvx2 = Histogram::hasAvx2();
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(pending.data());
+    size_t numBlocks = (pending.size() + blockSize - 1) / blockSize;
+    std::vector<FrequencyTable> frequencies(numBlocks);
+    std::vector<std::vector<uint8_t>> ownTables(numBlocks);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+        size_t first = static_cast<size_t>(block) * blockSize;
+        size_t count = std::min(first + blockSize, pending.size()) - first;
+        frequencies[block] = Histogram::countRange(bytes + first, count, useAvx2);
+        Huffman local;
+        local.maxCodeLength = maxCodeLength;
+        local.buildCodeLengths(frequencies[block]);
+        ownTables[block] = local.getCodeLengths();
+    }
+
+    // Block modes, in order: a block may reuse the table of the block before it
+    std::vector<BlockMode> modes(numBlocks);
+    std::vector<std::vector<uint8_t>> tables(numBlocks);
+    std::vector<uint64_t> payloadBytes(numBlocks);
+    for (size_t block = 0; block < numBlocks; ++block) {
+        size_t count = std::min((block + 1) * blockSize, pending.size()) - block * blockSize;
+        const FrequencyTable &histogram = frequencies[block];
+        bool previousUsable = !previousTable.empty();
+        uint64_t previousBits = Huffman::JUMP_TABLE_BITS, ownBits = Huffman::JUMP_TABLE_BITS;
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            if (!histogram[symbol]) continue;
+            if (previousUsable && !previousTable[symbol]) previousUsable = false;
+            if (previousUsable) previousBits += histogram[symbol] * previousTable[symbol];
+            ownBits += histogram[symbol] * ownTables[block][symbol];
+        }
+        uint64_t rawBits = static_cast<uint64_t>(count) * 8;
+        if (previousUsable && previousBits <= ownBits + Huffman::BLOCK_TABLE_BITS && previousBits < rawBits) {
+            modes[block] = PREVIOUS_TABLE;
+            tables[block] = previousTable;
+            payloadBytes[block] = (previousBits + 7) / 8;
+        } else if (ownBits + Huffman::BLOCK_TABLE_BITS < rawBits) {
+            modes[block] = NEW_TABLE;
+            tables[block] = ownTables[block];
+            previousTable = ownTables[block];
+            payloadBytes[block] = (ownBits + 7) / 8;
+        } else {
+            modes[block] = RAW;
+            payloadBytes[block] = count;
+        }
+    }
+
+    std::vector<std::vector<uint8_t>> payloads(numBlocks);
+    #pragma omp parallel for schedule(dynamic)
+    for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+        size_t first = static_cast<size_t>(block) * blockSize;
+        size_t count = std::min(first + blockSize, pending.size()) - first;
+        if (modes[block] == RAW) continue;
+        payloads[block].assign(payloadBytes[block], 0);
+        Huffman local;
+        local.setCodeLengths(tables[block]);
+        local.interleaved = true;
+        local.encodeBlock(bytes + first, count, payloads[block].data(), 0);
+    }
+
+    for (size_t block = 0; block < numBlocks; ++block) {
+        size_t first = block * blockSize;
+        size_t count = std::min(first + blockSize, pending.size()) - first;
+        uint8_t header[2 * WORD_BYTES + 1];
+        for (size_t i = 0; i < WORD_BYTES; ++i) {
+            header[i] = static_cast<uint8_t>(count >> (8 * i));
+            header[WORD_BYTES + 1 + i] = static_cast<uint8_t>(payloadBytes[block] >> (8 * i));
+        }
+        header[WORD_BYTES] = modes[block];
+        writeBytes(header, WORD_BYTES + 1);
+        if (modes[block] == NEW_TABLE) writeBytes(tables[block].data(), tables[block].size());
+        writeBytes(header + WORD_BYTES + 1, WORD_BYTES);
+        writeBytes(modes[block] == RAW ? bytes + first : payloads[block].data(), payloadBytes[block]);
+    }
+    pending.clear();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    elapsedMs += std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+}
+
+uint64_t HuffmanStreamEncoder::finish() {
+    /**
+     * Function to code the last (partial) batch and close the stream with an empty block
+     *
+     * @return: The number of bytes written to the stream
+     */
+    if (!out) {
+        throw std::invalid_argument("❌ Error: Streaming Huffman encoder used before begin");
+    }
+    if (!pending.empty()) flushBatch();
+    uint8_t terminator[WORD_BYTES] = {0};
+    writeBytes(terminator, WORD_BYTES);
+    out->flush();
+    out = nullptr;
+
+    printf("\033[1;36m🔵 [OpenMP (Huffman stream)] Threads used for compress: %d\033[0m\n", omp_get_max_threads());
+    printf("\033[1;32m🟢 [Timing] Stream compress time: %lld ms (%llu -> %llu bytes)\033[0m\n", elapsedMs,
+           static_cast<unsigned long long>(inputBytes), static_cast<unsigned long long>(outputBytes));
+    return outputBytes;
+}
+
+HuffmanStreamDecoder::HuffmanStreamDecoder() : in(nullptr), blockSize(0), havePrevious(false), finished(true) {
+    /**
+     * Constructor for the HuffmanStreamDecoder class
+     *
+     * @return: None
+     */
+}
+
+void HuffmanStreamDecoder::readBytes(void *data, size_t size) {
+    /**
+     * Function to read bytes from the input stream
+     *
+     * @param data: Where the bytes are written
+     * @param size: The number of bytes
+     *
+     * @return: None (throws std::invalid_argument if the stream ends early)
+     */
+    in->read(static_cast<char *>(data), static_cast<std::streamsize>(size));
+    if (static_cast<size_t>(in->gcount()) != size) {
+        throw std::invalid_argument("❌ Error: Truncated Huffman stream");
+    }
+}
+
+uint32_t HuffmanStreamDecoder::readWord() {
+    /**
+     * Function to read a little-endian 4-byte integer from the input stream
+     *
+     * @return: The integer
+     */
+    uint8_t bytes[WORD_BYTES];
+    readBytes(bytes, WORD_BYTES);
+    uint32_t value = 0;
+    for (size_t i = 0; i < WORD_BYTES; ++i) value |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+    return value;
+}
+
+void HuffmanStreamDecoder::begin(std::istream &input) {
+    /**
+     * Function to start decoding a stream written by HuffmanStreamEncoder, reading its header
+     *
+     * @param input: The coded stream
+     *
+     * @return: None
+     */
+    in = &input;
+    blockSize = readWord();
+    if (blockSize == 0 || blockSize > HuffmanStreamEncoder::MAX_BLOCK_SIZE) {
+        throw std::invalid_argument("❌ Error: Invalid Huffman stream header");
+    }
+    havePrevious = false;
+    finished = false;
+}
+
+bool HuffmanStreamDecoder::pull(std::vector<char> &chunk) {
+    /**
+     * Function to decode the next batch of up to one block per thread. The payloads are read
+     * in order, then the blocks are decoded in parallel straight into the chunk.
+     *
+     * @param chunk: Replaced by the next decoded bytes
+     *
+     * @return: true if a chunk was decoded, false once the end of the stream was reached
+     */
+    chunk.clear();
+    if (finished) return false;
+
+    struct PendingBlock {
+        size_t count;
+        size_t outputOffset;
+        int table;  // Index in `tables`, -1 for raw blocks
+        std::vector<uint8_t> payload;
+    };
+    std::vector<Huffman> tables;
+    if (havePrevious) tables.push_back(previous);
+    std::vector<PendingBlock> batch;
+    size_t outputSize = 0;
+    size_t maxBlocks = omp_get_max_threads();
+    while (batch.size() < maxBlocks) {
+        size_t count = readWord();
+        if (count == 0) {
+            finished = true;
+            break;
+        }
+        uint8_t mode;
+        readBytes(&mode, 1);
+        if (count > blockSize || mode > HuffmanStreamEncoder::PREVIOUS_TABLE ||
+            (mode == HuffmanStreamEncoder::PREVIOUS_TABLE && tables.empty())) {
+            throw std::invalid_argument("❌ Error: Invalid Huffman stream block");
+        }
+        if (mode == HuffmanStreamEncoder::NEW_TABLE) {
+            std::vector<uint8_t> lengths(256);
+            readBytes(lengths.data(), lengths.size());
+            tables.emplace_back();
+            tables.back().setCodeLengths(lengths);
+            tables.back().interleaved = true;
+        }
+        size_t payloadBytes = readWord();
+        uint64_t maxPayload = mode == HuffmanStreamEncoder::RAW
+            ? count : (Huffman::JUMP_TABLE_BITS + static_cast<uint64_t>(count) * Huffman::MAX_CODE_LENGTH + 7) / 8;
+        if (payloadBytes > maxPayload || (mode == HuffmanStreamEncoder::RAW && payloadBytes != count)) {
+            throw std::invalid_argument("❌ Error: Invalid Huffman stream block");
+        }
+        PendingBlock block{count, outputSize, mode == HuffmanStreamEncoder::RAW ? -1 : static_cast<int>(tables.size()) - 1, {}};
+        block.payload.resize(payloadBytes);
+        readBytes(block.payload.data(), payloadBytes);
+        batch.push_back(std::move(block));
+        outputSize += count;
+    }
+    if (batch.empty()) return false;
+
+    for (Huffman &table : tables) table.buildDecodeTable();
+    chunk.resize(outputSize);
+    bool valid = true;
+    #pragma omp parallel for schedule(dynamic) reduction(&& : valid)
+    for (long long i = 0; i < static_cast<long long>(batch.size()); ++i) {
+        const PendingBlock &block = batch[i];
+        if (block.table < 0) {
+            std::memcpy(chunk.data() + block.outputOffset, block.payload.data(), block.count);
+            continue;
+        }
+        valid = tables[block.table].decodeAnyBlock(block.payload, 0, chunk.data() + block.outputOffset, block.count) && valid;
+    }
+    if (!valid) {
+        throw std::invalid_argument("❌ Error: Invalid Huffman code in stream");
+    }
+
+    if (!tables.empty()) {
+        previous = tables.back();
+        havePrevious = true;
+    }
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef HUFFMAN_STREAM_H
+#define HUFFMAN_STREAM_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "Huffman.h"
+
+// Streaming Huffman coding for inputs that do not fit in memory. The input is pushed in chunks
+// of any size and cut into blocks; every block is coded with the previous block's table when
+// that is cheapest, with a table built from its own histogram, or stored raw. A batch of one
+// block per thread is coded at a time, so memory stays at a few blocks whatever the input size.
+//
+// Stream layout: block size (4 bytes), then per block its symbol count (4 bytes), its mode,
+// the 256 code lengths if it brings a new table, its payload size (4 bytes) and the payload.
+// A block of 0 symbols ends the stream. Integers are little-endian.
+class HuffmanStreamEncoder {
+private:
+    std::ostream *out;
+    size_t blockSize;
+    unsigned maxCodeLength;
+    std::vector<char> pending;          // Input of the blocks of the current batch
+    std::vector<uint8_t> previousTable; // Code lengths of the last table written, empty at first
+    uint64_t inputBytes;
+    uint64_t outputBytes;
+    long long elapsedMs;
+
+    void writeBytes(const void *data, size_t size);
+    void flushBatch();
+public:
+    enum BlockMode : uint8_t { RAW = 0, NEW_TABLE = 1, PREVIOUS_TABLE = 2 };
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1 << 18;
+    static constexpr size_t MAX_BLOCK_SIZE = 1 << 24;
+
+    explicit HuffmanStreamEncoder(size_t blockSize = DEFAULT_BLOCK_SIZE, unsigned maxCodeLength = 0);
+    void begin(std::ostream &output);
+    void push(const char *data, size_t size);
+    void push(const std::vector<char> &chunk);
+    uint64_t finish();
+};
+
+class HuffmanStreamDecoder {
+private:
+    std::istream *in;
+    size_t blockSize;
+    Huffman previous;        // Table of the last block that carried one
+    bool havePrevious;
+    bool finished;
+
+    void readBytes(void *data, size_t size);
+    uint32_t readWord();
+public:
+    HuffmanStreamDecoder();
+    void begin(std::istream &input);
+    bool pull(std::vector<char> &chunk);
+};
+
+#endif
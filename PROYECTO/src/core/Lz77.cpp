@@ -0,0 +1,337 @@
+#include "Lz77.h"
+#include <omp.h>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+static inline uint32_t hashAt(const uint8_t *data, unsigned hashBits) {
+    /**
+     * Function to hash the 4 bytes at a position (multiplicative hashing)
+     *
+     * @param data: The first of the 4 bytes
+     * @param hashBits: The width of the hash
+     *
+     * @return: The hash, below 2^hashBits
+     */
+    uint32_t word;
+    std::memcpy(&word, data, sizeof(uint32_t));
+    return (word * 2654435761u) >> (32 - hashBits);
+}
+
+static inline size_t matchLength(const uint8_t *a, const uint8_t *b, size_t limit) {
+    /**
+     * Function to count how many bytes two positions have in common, 8 bytes at a time
+     *
+     * @param a: The first position
+     * @param b: The second position
+     * @param limit: The maximum length to compare (both ranges must be readable up to it)
+     *
+     * @return: The length of the common prefix
+     */
+    size_t length = 0;
+    while (length + 8 <= limit) {
+        uint64_t x, y;
+        std::memcpy(&x, a + length, sizeof(uint64_t));
+        std::memcpy(&y, b + length, sizeof(uint64_t));
+        if (x != y) return length + (__builtin_ctzll(x ^ y) >> 3);
+        length += 8;
+    }
+    while (length < limit && a[length] == b[length]) length++;
+    return length;
+}
+
+Lz77::Lz77() : windowSize(DEFAULT_WINDOW_SIZE), searchDepth(DEFAULT_SEARCH_DEPTH) {
+    /**
+     * Constructor for the Lz77 class
+     *
+     * @return: None
+     */
+}
+
+void Lz77::setWindowSize(size_t size) {
+    /**
+     * Function to set how far back a match can start
+     *
+     * @param size: The window size in bytes, a power of two between MIN_WINDOW_SIZE and MAX_WINDOW_SIZE
+     *
+     * @return: None
+     */
+    if (size < MIN_WINDOW_SIZE || size > MAX_WINDOW_SIZE || (size & (size - 1)) != 0) {
+        throw std::invalid_argument("❌ Error: LZ77 window must be a power of two between " + std::to_string(MIN_WINDOW_SIZE) +
+                                    " and " + std::to_string(MAX_WINDOW_SIZE) + " bytes");
+    }
+    windowSize = size;
+}
+
+void Lz77::setSearchDepth(unsigned depth) {
+    /**
+     * Function to set how many earlier positions of the hash chain are tried for every match.
+     * Deeper searches find longer matches but take longer.
+     *
+     * @param depth: The maximum number of candidates per position (at least 1)
+     *
+     * @return: None
+     */
+    if (depth == 0) {
+        throw std::invalid_argument("❌ Error: LZ77 search depth must be greater than 0");
+    }
+    searchDepth = depth;
+}
+
+void Lz77::writeLength(std::vector<uint8_t> &out, size_t length) {
+    /**
+     * Function to write the part of a length that does not fit its 4-bit token field: a run
+     * of 255 bytes and a final byte below 255
+     *
+     * @param out: The command buffer
+     * @param length: The remaining length
+     *
+     * @return: None
+     */
+    while (length >= 255) {
+        out.push_back(255);
+        length -= 255;
+    }
+    out.push_back(static_cast<uint8_t>(length));
+}
+
+bool Lz77::readLength(const uint8_t *&in, const uint8_t *end, size_t &length) {
+    /**
+     * Function to read the extension of a length written by writeLength and add it
+     *
+     * @param in: The read position in the command region, advanced past the extension
+     * @param end: The end of the command region
+     * @param length: The length to extend
+     *
+     * @return: false if the command region ends inside the extension
+     */
+    uint8_t byte;
+    do {
+        if (in >= end) return false;
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+void Lz77::parseChunk(const uint8_t *data, size_t size, size_t chunkStart, size_t chunkEnd, unsigned distanceBytes,
+                      std::vector<uint8_t> &commands, std::vector<uint8_t> &literals) const {
+    /**
+     * Function to turn one chunk of the input into sequences (a literal run followed by a
+     * match). Matches are found through hash chains over the last windowSize bytes, including
+     * the bytes before the chunk, so chunks can be parsed in parallel without losing matches.
+     * A match is deferred by one byte when the next position has a longer one (lazy matching).
+     *
+     * @param data: The whole input
+     * @param size: The size of the whole input
+     * @param chunkStart: The first byte of the chunk
+     * @param chunkEnd: The end of the chunk (matches do not cross it)
+     * @param distanceBytes: The width of a distance in the command region
+     * @param commands: Where the commands of the chunk are appended
+     * @param literals: Where the literal bytes of the chunk are appended
+     *
+     * @return: None
+     */
+    const size_t base = chunkStart > windowSize ? chunkStart - windowSize : 0;
+    const size_t mask = windowSize - 1;
+    std::vector<int32_t> head(size_t(1) << HASH_BITS, -1);
+    std::vector<int32_t> previous(windowSize, -1);  // Chain links, indexed by position modulo the window
+
+    // Positions are stored relative to `base`, which keeps them in 32 bits
+    size_t nextInsert = base;
+    auto insertUpTo = [&](size_t target) {
+        for (; nextInsert < target; ++nextInsert) {
+            if (nextInsert + MIN_MATCH > size) continue;
+            uint32_t hash = hashAt(data + nextInsert, HASH_BITS);
+            previous[(nextInsert - base) & mask] = head[hash];
+            head[hash] = static_cast<int32_t>(nextInsert - base);
+        }
+    };
+    auto findMatch = [&](size_t position, size_t &bestLength, size_t &bestDistance) {
+        bestLength = 0;
+        size_t limit = chunkEnd - position;
+        if (limit < MIN_MATCH) return;
+        int32_t candidate = head[hashAt(data + position, HASH_BITS)];
+        for (unsigned depth = 0; depth < searchDepth && candidate >= 0; ++depth) {
+            size_t start = base + static_cast<size_t>(candidate);
+            size_t distance = position - start;
+            if (distance >= windowSize) break;
+            if (data[start + bestLength] == data[position + bestLength] || bestLength == 0) {
+                size_t length = matchLength(data + start, data + position, limit);
+                if (length > bestLength) {
+                    bestLength = length;
+                    bestDistance = distance;
+                    if (length == limit) break;
+                }
+            }
+            candidate = previous[candidate & mask];
+        }
+        if (bestLength < MIN_MATCH) bestLength = 0;
+    };
+    auto emit = [&](size_t literalStart, size_t literalEnd, size_t length, size_t distance) {
+        size_t literalLength = literalEnd - literalStart;
+        size_t matchCode = length ? length - MIN_MATCH : 0;
+        commands.push_back(static_cast<uint8_t>((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(matchCode, 15)));
+        if (literalLength >= 15) writeLength(commands, literalLength - 15);
+        literals.insert(literals.end(), data + literalStart, data + literalEnd);
+        // Distance 0 marks a literal run without a match
+        for (unsigned i = 0; i < distanceBytes; ++i) {
+            commands.push_back(static_cast<uint8_t>(distance >> (8 * i)));
+        }
+        if (length && matchCode >= 15) writeLength(commands, matchCode - 15);
+    };
+
+    insertUpTo(chunkStart);
+    size_t position = chunkStart, literalStart = chunkStart;
+    while (position < chunkEnd) {
+        size_t length, distance;
+        findMatch(position, length, distance);
+        if (!length) {
+            position++;
+            insertUpTo(position);
+            continue;
+        }
+        while (position + 1 < chunkEnd) {
+            insertUpTo(position + 1);
+            size_t nextLength, nextDistance;
+            findMatch(position + 1, nextLength, nextDistance);
+            if (nextLength <= length) break;
+            position++;
+            length = nextLength;
+            distance = nextDistance;
+        }
+        emit(literalStart, position, length, distance);
+        position += length;
+        literalStart = position;
+        insertUpTo(position);
+    }
+    if (literalStart < chunkEnd) emit(literalStart, chunkEnd, 0, 0);
+}
+
+std::vector<char> Lz77::compress(const std::vector<char> &data) const {
+    /**
+     * Function to apply the LZ77 transform. The input is cut into chunks of CHUNK_SIZE bytes
+     * parsed in parallel with OpenMP; their commands and literals are then concatenated.
+     *
+     * @param data: The data to be transformed
+     *
+     * @return: The header, the command region and the literal region
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    int numThreads = omp_get_max_threads();
+    printf("\033[1;36m🔵 [OpenMP (LZ77)] Threads used for match finding: %d\033[0m\n", numThreads);
+
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    const unsigned distanceBytes = windowSize <= (size_t(1) << 16) ? 2 : 3;
+    size_t numChunks = (data.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::vector<std::vector<uint8_t>> commands(numChunks), literals(numChunks);
+    #pragma omp parallel for schedule(dynamic)
+    for (long long chunk = 0; chunk < static_cast<long long>(numChunks); ++chunk) {
+        size_t first = static_cast<size_t>(chunk) * CHUNK_SIZE;
+        size_t last = std::min(first + CHUNK_SIZE, data.size());
+        parseChunk(bytes, data.size(), first, last, distanceBytes, commands[chunk], literals[chunk]);
+    }
+
+    size_t commandBytes = 0, literalBytes = 0;
+    for (size_t chunk = 0; chunk < numChunks; ++chunk) {
+        commandBytes += commands[chunk].size();
+        literalBytes += literals[chunk].size();
+    }
+    std::vector<char> out;
+    out.reserve(HEADER_BYTES + commandBytes + literalBytes);
+    out.push_back(static_cast<char>(distanceBytes));
+    for (unsigned i = 0; i < 8; ++i) out.push_back(static_cast<char>(static_cast<uint64_t>(data.size()) >> (8 * i)));
+    for (unsigned i = 0; i < 8; ++i) out.push_back(static_cast<char>(static_cast<uint64_t>(commandBytes) >> (8 * i)));
+    for (const std::vector<uint8_t> &region : commands) out.insert(out.end(), region.begin(), region.end());
+    for (const std::vector<uint8_t> &region : literals) out.insert(out.end(), region.begin(), region.end());
+
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] LZ77 compress time: %lld ms (%zu -> %zu bytes)\033[0m\n",
+           static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()), data.size(), out.size());
+    return out;
+}
+
+std::vector<char> Lz77::uncompress(const std::vector<char> &data) {
+    /**
+     * Function to undo the LZ77 transform: every sequence copies its literals and then its
+     * match from the output already written
+     *
+     * @param data: The output of compress
+     *
+     * @return: The original data (throws std::invalid_argument if the stream is corrupted)
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    if (data.size() < HEADER_BYTES || (data[0] != 2 && data[0] != 3)) {
+        throw std::invalid_argument("❌ Error: Invalid LZ77 header");
+    }
+    const uint8_t *in = reinterpret_cast<const uint8_t *>(data.data());
+    unsigned distanceBytes = in[0];
+    uint64_t outputSize = 0, commandBytes = 0;
+    for (unsigned i = 0; i < 8; ++i) {
+        outputSize |= static_cast<uint64_t>(in[1 + i]) << (8 * i);
+        commandBytes |= static_cast<uint64_t>(in[9 + i]) << (8 * i);
+    }
+    if (commandBytes > data.size() - HEADER_BYTES) {
+        throw std::invalid_argument("❌ Error: Invalid LZ77 header");
+    }
+    const uint8_t *command = in + HEADER_BYTES;
+    const uint8_t *commandEnd = command + commandBytes;
+    const uint8_t *literal = commandEnd;
+    const uint8_t *literalEnd = in + data.size();
+
+    // 8 bytes of slack let matches be copied a word at a time
+    std::vector<char> decoded(outputSize + 8);
+    uint8_t *outStart = reinterpret_cast<uint8_t *>(decoded.data());
+    uint8_t *out = outStart;
+    uint8_t *outEnd = outStart + outputSize;
+    bool valid = true;
+    while (command < commandEnd && valid) {
+        uint8_t token = *command++;
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(command, commandEnd, literalLength)) valid = false;
+        if (!valid || literalLength > static_cast<size_t>(literalEnd - literal) || literalLength > static_cast<size_t>(outEnd - out)) {
+            valid = false;
+            break;
+        }
+        std::memcpy(out, literal, literalLength);
+        out += literalLength;
+        literal += literalLength;
+        if (command == commandEnd) break;
+
+        if (static_cast<size_t>(commandEnd - command) < distanceBytes) {
+            valid = false;
+            break;
+        }
+        size_t distance = 0;
+        for (unsigned i = 0; i < distanceBytes; ++i) distance |= static_cast<size_t>(command[i]) << (8 * i);
+        command += distanceBytes;
+        if (distance == 0) continue;
+
+        size_t length = token & 0x0F;
+        if (length == 15 && !readLength(command, commandEnd, length)) {
+            valid = false;
+            break;
+        }
+        length += MIN_MATCH;
+        if (distance > static_cast<size_t>(out - outStart) || length > static_cast<size_t>(outEnd - out)) {
+            valid = false;
+            break;
+        }
+        const uint8_t *source = out - distance;
+        if (distance >= 8) {
+            for (size_t i = 0; i < length; i += 8) std::memcpy(out + i, source + i, 8);
+        } else {
+            for (size_t i = 0; i < length; ++i) out[i] = source[i];
+        }
+        out += length;
+    }
+    if (!valid || out != outEnd || literal != literalEnd) {
+        throw std::invalid_argument("❌ Error: Corrupted LZ77 stream");
+    }
+    decoded.resize(outputSize);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] LZ77 uncompress time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+    return decoded;
+}
@@ -0,0 +1,40 @@
+#ifndef LZ77_H
+#define LZ77_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// LZ77 transform applied before entropy coding. The output holds a header, the command
+// region (literal run lengths, match lengths and distances) and the literal bytes, so both
+// kinds of data reach the entropy coder in long runs of their own.
+class Lz77 {
+private:
+    static constexpr unsigned MIN_MATCH = 4;
+    static constexpr unsigned HASH_BITS = 16;
+    static constexpr size_t HEADER_BYTES = 1 + 8 + 8;  // Distance width, output size, command bytes
+    static constexpr size_t CHUNK_SIZE = size_t(1) << 22;  // Input parsed by one thread
+
+    size_t windowSize;
+    unsigned searchDepth;
+
+    void parseChunk(const uint8_t *data, size_t size, size_t chunkStart, size_t chunkEnd, unsigned distanceBytes,
+                    std::vector<uint8_t> &commands, std::vector<uint8_t> &literals) const;
+    static void writeLength(std::vector<uint8_t> &out, size_t length);
+    static bool readLength(const uint8_t *&in, const uint8_t *end, size_t &length);
+public:
+    static constexpr size_t DEFAULT_WINDOW_SIZE = size_t(1) << 20;
+    static constexpr unsigned DEFAULT_SEARCH_DEPTH = 32;
+    static constexpr size_t MIN_WINDOW_SIZE = size_t(1) << 10;
+    static constexpr size_t MAX_WINDOW_SIZE = size_t(1) << 24;
+
+    Lz77();
+    void setWindowSize(size_t size);
+    void setSearchDepth(unsigned depth);
+    std::vector<char> compress(const std::vector<char> &data) const;
+    static std::vector<char> uncompress(const std::vector<char> &data);
+};
+
+#endif
@@ -2,10 +2,188 @@
 #include <numeric>
 #include <chrono>
 #include <iostream>
+#include <cstring>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 
+namespace
+{
+    // Reverse lookup from ciphertext words to bytes for one thread. The private key alone can not
+    // enumerate the 256 ciphertexts, but every word always decrypts to the same byte, so each
+    // distinct word is exponentiated once and found here afterwards (open addressing, linear probing).
+    class DecryptCache
+    {
+    private:
+        static constexpr unsigned SLOT_BITS = 12;
+        static constexpr size_t SLOTS = size_t(1) << SLOT_BITS;
+        static constexpr size_t MAX_ENTRIES = SLOTS / 2;  // Words beyond this are just exponentiated
+
+        uint32_t words[SLOTS];
+        int16_t bytes[SLOTS];  // -1 marks an empty slot
+        size_t entries = 0;
+
+        static size_t slotOf(uint32_t word)
+        {
+            return (word * 0x9E3779B1u) >> (32 - SLOT_BITS);
+        }
+
+    public:
+        DecryptCache()
+        {
+            std::fill(bytes, bytes + SLOTS, static_cast<int16_t>(-1));
+        }
+
+        int find(uint32_t word) const
+        {
+            /**
+             * Function to look up the byte of a word decrypted before
+             *
+             * @param word: The ciphertext word
+             *
+             * @return: The byte, or -1 if the word is not in the cache
+             */
+            for (size_t slot = slotOf(word);; slot = (slot + 1) & (SLOTS - 1))
+            {
+                if (bytes[slot] < 0 || words[slot] == word)
+                {
+                    return bytes[slot];
+                }
+            }
+        }
+
+        void insert(uint32_t word, uint8_t byte)
+        {
+            /**
+             * Function to remember the byte of a word that is not in the cache yet
+             *
+             * @param word: The ciphertext word
+             * @param byte: The byte it decrypts to
+             *
+             * @return: None
+             */
+            if (entries >= MAX_ENTRIES)
+            {
+                return;
+            }
+            size_t slot = slotOf(word);
+            while (bytes[slot] >= 0)
+            {
+                slot = (slot + 1) & (SLOTS - 1);
+            }
+            words[slot] = word;
+            bytes[slot] = byte;
+            entries++;
+        }
+    };
+
+    // Private key schedule for decryption through the Chinese remainder theorem
+    struct CrtKey
+    {
+        int p, q;
+        int dP, dQ;  // d mod (p - 1) and d mod (q - 1)
+        int qInv;    // q^-1 mod p
+    };
+
+    int crtPowerModulus(int base, const CrtKey &key)
+    {
+        /**
+         * Function to compute base^d mod (p * q) from the residues modulo p and q (Garner's formula)
+         *
+         * @param base: The ciphertext value
+         * @param key: The CRT key schedule
+         *
+         * @return: base^d mod (p * q)
+         */
+        long long m1 = Utils::powerModulus(base % key.p, key.dP, key.p);
+        long long m2 = Utils::powerModulus(base % key.q, key.dQ, key.q);
+        long long h = key.qInv * ((m1 - m2 % key.p + key.p) % key.p) % key.p;
+        return static_cast<int>(m2 + h * key.q);
+    }
+
+    // Packed ciphertext is cut into groups of GROUP_VALUES values, which fill exactly
+    // GROUP_VALUES / 8 * bits bytes, so groups are packed and unpacked independently
+    constexpr size_t GROUP_VALUES = 8 * 1024;
+
+    void packGroup(const uint32_t *values, size_t count, unsigned bits, uint8_t *out)
+    {
+        /**
+         * Function to pack values MSB-first at a fixed width, writing 32 bits at a time
+         *
+         * @param values: The values, each below 2^bits
+         * @param count: The number of values
+         * @param bits: The width of every value (at most 32)
+         * @param out: Where the ceil(count * bits / 8) packed bytes are written
+         *
+         * @return: None
+         */
+        uint64_t accumulator = 0;
+        unsigned filled = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            accumulator = (accumulator << bits) | values[i];
+            filled += bits;
+            if (filled >= 32)
+            {
+                filled -= 32;
+                uint32_t word = static_cast<uint32_t>(accumulator >> filled);
+                out[0] = static_cast<uint8_t>(word >> 24);
+                out[1] = static_cast<uint8_t>(word >> 16);
+                out[2] = static_cast<uint8_t>(word >> 8);
+                out[3] = static_cast<uint8_t>(word);
+                out += 4;
+            }
+        }
+        // The last bits are padded with zeros up to a whole byte
+        unsigned padding = (8 - filled % 8) % 8;
+        accumulator <<= padding;
+        for (filled += padding; filled > 0; filled -= 8)
+        {
+            *out++ = static_cast<uint8_t>(accumulator >> (filled - 8));
+        }
+    }
+
+    void unpackGroup(const uint8_t *in, size_t inBytes, size_t count, unsigned bits, uint32_t *values)
+    {
+        /**
+         * Function to read back values packed by packGroup, loading 32 bits at a time
+         *
+         * @param in: The packed bytes
+         * @param inBytes: The number of packed bytes
+         * @param count: The number of values to read
+         * @param bits: The width of every value (at most 32)
+         * @param values: Where the values are written
+         *
+         * @return: None
+         */
+        const uint64_t mask = (uint64_t(1) << bits) - 1;
+        uint64_t accumulator = 0;
+        unsigned filled = 0;
+        size_t position = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            while (filled < bits)
+            {
+                if (position + 4 <= inBytes)
+                {
+                    accumulator = (accumulator << 32) | (static_cast<uint64_t>(in[position]) << 24) |
+                                  (static_cast<uint64_t>(in[position + 1]) << 16) |
+                                  (static_cast<uint64_t>(in[position + 2]) << 8) | in[position + 3];
+                    filled += 32;
+                    position += 4;
+                }
+                else
+                {
+                    accumulator = (accumulator << 8) | in[position++];
+                    filled += 8;
+                }
+            }
+            filled -= bits;
+            values[i] = static_cast<uint32_t>((accumulator >> filled) & mask);
+        }
+    }
+}
+
 Rsa::Rsa(int p, int q) : p(p), q(q), publicKey(nullptr), privateKey(nullptr)
 {
     /**
@@ -37,36 +215,73 @@ ResultGenerateKeys Rsa::generateKeys()
      */
     int n, e;
 
+    // With p = 2 or q = 2, d mod (p - 1) is 0 and the CRT residue modulo 2 is lost
+    if (this->p % 2 == 0 || this->q % 2 == 0)
+    {
+        throw std::invalid_argument("❌ Error: The primes must be odd to build a key");
+    }
+
     // Calculate the Euler's Totient Function of n
     n = this->p * this->q;
     int phi = (this->p - 1) * (this->q - 1);
 
-    // Choose e, where 1 < e < phi(n) and gcd(e, phi(n)) == 1
-    for (e = 2; e < phi; e++)
+    // Choose e, where 1 < e < phi(n) and gcd(e, phi(n)) == 1: the standard 65537 when it fits,
+    // otherwise a random odd value
+    e = PUBLIC_EXPONENT;
+    while (e >= phi || std::__gcd(static_cast<unsigned int>(e), static_cast<unsigned int>(phi)) != 1)
     {
-        if (std::__gcd(static_cast<unsigned int>(e), static_cast<unsigned int>(phi)) == 1)
+        if (phi <= 3)
         {
-            break;
+            throw std::invalid_argument("❌ Error: The primes are too small to build a key");
         }
+        e = 3 + 2 * static_cast<int>(Utils::randomNumber(static_cast<uint64_t>(phi - 2) / 2));
     }
 
     // Compute d such that e * d ≡ 1 (mod phi(n))
     int d = Utils::modInverse(e, phi);
 
+    // CRT key schedule; p is prime, so q^-1 mod p = q^(p - 2) mod p
+    int dP = d % (this->p - 1);
+    int dQ = d % (this->q - 1);
+    int qInv = Utils::powerModulus(this->q % this->p, this->p - 2, this->p);
+
     // Convert the keys to string format
     ResultGenerateKeys result;
     result.publicKey = Utils::numbersToBase64({e, n});
-    result.privateKey = Utils::numbersToBase64({d, n});
+    result.privateKey = Utils::numbersToBase64({d, n, this->p, this->q, dP, dQ, qInv});
     return result;
 }
 
-std::vector<uint8_t> Rsa::encrypt(const std::vector<uint8_t> &data, const std::string &publicKeyStr)
+unsigned Rsa::cipherBits(const std::string &keyStr)
+{
+    /**
+     * Function to get the number of bits every ciphertext value needs, ceil(log2 n)
+     *
+     * @param keyStr: The public or private key in string format
+     *
+     * @return: The width of a ciphertext value in bits
+     */
+    std::vector<int> keyValues = Utils::base64ToNumbers(keyStr.c_str());
+    if (keyValues.size() < 2 || keyValues[1] < 2)
+    {
+        throw std::invalid_argument("❌ Error: Invalid key format");
+    }
+    unsigned bits = 0;
+    while ((int64_t(1) << bits) < keyValues[1])
+    {
+        bits++;
+    }
+    return bits;
+}
+
+std::vector<uint8_t> Rsa::encrypt(const std::vector<uint8_t> &data, const std::string &publicKeyStr, unsigned packedBits)
 {
     /**
      * Function to encrypt the data using the public key
      *
      * @param data: The data to be encrypted
      * @param publicKeyStr: The public key in string format
+     * @param packedBits: The width ciphertext values are packed at, 0 for 4-byte words
      *
      * @return: The encrypted data
      */
@@ -89,12 +304,59 @@ std::vector<uint8_t> Rsa::encrypt(const std::vector<uint8_t> &data, const std::s
         throw std::invalid_argument("❌ Error: Modulus n is too small to encrypt byte values (must be >= 256)");
     }
 
+    if (packedBits != 0 && (packedBits > 32 || packedBits < cipherBits(publicKeyStr)))
+    {
+        throw std::invalid_argument("❌ Error: Packed width must hold every value below n (and be at most 32 bits)");
+    }
+
     auto start = std::chrono::high_resolution_clock::now();
+
+    // The plaintext alphabet is 256 bytes, so encryption is a fixed substitution: exponentiate
+    // every byte once and store its ciphertext word in output (big-endian) byte order
+    uint8_t table[256][4];
+    uint32_t values[256];
+    for (int byte = 0; byte < 256; byte++)
+    {
+        int encrypted = Utils::powerModulus(byte, e, n);
+        if (encrypted >= n)
+        {
+            throw std::runtime_error("❌ Error: Encrypted value exceeds modulus n");
+        }
+        table[byte][0] = static_cast<uint8_t>(encrypted >> 24);
+        table[byte][1] = static_cast<uint8_t>(encrypted >> 16);
+        table[byte][2] = static_cast<uint8_t>(encrypted >> 8);
+        table[byte][3] = static_cast<uint8_t>(encrypted & 0xFF);
+        values[byte] = static_cast<uint32_t>(encrypted);
+    }
+
+    if (packedBits)
+    {
+        std::vector<uint8_t> packedValues((data.size() * packedBits + 7) / 8);
+        const size_t groups = (data.size() + GROUP_VALUES - 1) / GROUP_VALUES;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (size_t group = 0; group < groups; group++)
+        {
+            size_t first = group * GROUP_VALUES;
+            size_t count = std::min(GROUP_VALUES, data.size() - first);
+            uint32_t groupValues[GROUP_VALUES];
+            for (size_t i = 0; i < count; i++)
+            {
+                groupValues[i] = values[data[first + i]];
+            }
+            packGroup(groupValues, count, packedBits, &packedValues[first / 8 * packedBits]);
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        printf("\033[1;32m🟢 [Timing] Encryption time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+        return packedValues;
+    }
+
     std::vector<uint8_t> encryptedValues(data.size() * 4); // Pre-allocate the vector
 
 #ifdef _OPENMP
     omp_set_num_threads(omp_get_max_threads());
-#pragma omp parallel for
+#pragma omp parallel for schedule(static)
 #endif
     for (size_t i = 0; i < data.size(); i++)
     {
@@ -104,30 +366,21 @@ std::vector<uint8_t> Rsa::encrypt(const std::vector<uint8_t> &data, const std::s
             printf("\033[1;36m🔵 [OpenMP (RSA)] Threads used for encryption: %d\033[0m\n", omp_get_num_threads());
         }
 #endif
-        uint8_t byte = data[i];
-        int encrypted = Utils::powerModulus(static_cast<int>(byte), e, n);
-        if (encrypted >= n)
-        {
-            throw std::runtime_error("❌ Error: Encrypted value exceeds modulus n");
-        }
-        size_t baseIndex = i * 4;
-        encryptedValues[baseIndex] = static_cast<uint8_t>(encrypted >> 24);
-        encryptedValues[baseIndex + 1] = static_cast<uint8_t>(encrypted >> 16);
-        encryptedValues[baseIndex + 2] = static_cast<uint8_t>(encrypted >> 8);
-        encryptedValues[baseIndex + 3] = static_cast<uint8_t>(encrypted & 0xFF);
+        std::memcpy(&encryptedValues[i * 4], table[data[i]], 4);
     }
     auto end = std::chrono::high_resolution_clock::now();
-    printf("\033[1;32m🟢 [Timing] Encryption time: %lld ms\033[0m\n", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    printf("\033[1;32m🟢 [Timing] Encryption time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
     return encryptedValues;
 }
 
-std::vector<uint8_t> Rsa::decrypt(const std::vector<uint8_t> &data, const std::string &privateKeyStr)
+std::vector<uint8_t> Rsa::decrypt(const std::vector<uint8_t> &data, const std::string &privateKeyStr, unsigned packedBits)
 {
     /**
      * Function to decrypt the data using the private key
      *
      * @param data: The encrypted data to be decrypted
      * @param privateKeyStr: The private key in string format
+     * @param packedBits: The width ciphertext values were packed at, 0 for 4-byte words
      *
      * @return: The decrypted data
      */
@@ -136,49 +389,102 @@ std::vector<uint8_t> Rsa::decrypt(const std::vector<uint8_t> &data, const std::s
         throw std::invalid_argument("❌ Error: No private key provided");
     }
 
-    if (data.size() % 4 != 0)
+    if (packedBits > 32 || (packedBits != 0 && packedBits < 8))
+    {
+        throw std::invalid_argument("❌ Error: Invalid packed ciphertext width");
+    }
+    if (!packedBits && data.size() % 4 != 0)
     {
         throw std::invalid_argument("❌ Error: Invalid encrypted data length (must be multiple of 4)");
     }
 
     std::vector<int> privateKeyValues = Utils::base64ToNumbers(privateKeyStr.c_str());
-    if (privateKeyValues.size() != 2)
+    const bool crt = privateKeyValues.size() == 7;  // Keys with only {d, n} are decrypted without CRT
+    if (privateKeyValues.size() != 2 && !crt)
     {
         throw std::invalid_argument("❌ Error: Invalid private key format");
     }
     int d = privateKeyValues[0];
     int n = privateKeyValues[1];
+    CrtKey crtKey{};
+    if (crt)
+    {
+        crtKey = {privateKeyValues[2], privateKeyValues[3], privateKeyValues[4], privateKeyValues[5], privateKeyValues[6]};
+        if (crtKey.p < 2 || crtKey.q < 2 || static_cast<long long>(crtKey.p) * crtKey.q != n)
+        {
+            throw std::invalid_argument("❌ Error: Invalid private key format");
+        }
+    }
 
     auto start = std::chrono::high_resolution_clock::now();
-    std::vector<uint8_t> decryptedValues(data.size() / 4); // Pre-allocate the vector
+    const size_t count = packedBits ? data.size() * 8 / packedBits : data.size() / 4;  // Padding is under 8 bits
+    std::vector<uint8_t> decryptedValues(count); // Pre-allocate the vector
+    const size_t groups = (count + GROUP_VALUES - 1) / GROUP_VALUES;
 
 #ifdef _OPENMP
     omp_set_num_threads(omp_get_max_threads());
-#pragma omp parallel for
+#pragma omp parallel
 #endif
-    for (size_t i = 0; i < data.size(); i += 4)
     {
+        DecryptCache cache;
+        uint32_t groupValues[GROUP_VALUES];
 #ifdef _OPENMP
-        if (i == 0)
-        {
-            printf("\033[1;36m🔵 [OpenMP (RSA)] Threads used for decryption: %d\033[0m\n", omp_get_num_threads());
-        }
+#pragma omp for schedule(static)
 #endif
-        int encrypted = (static_cast<int>(data[i]) << 24) |
-                        (static_cast<int>(data[i + 1]) << 16) |
-                        (static_cast<int>(data[i + 2]) << 8) |
-                        static_cast<int>(data[i + 3]);
-        int decrypted = Utils::powerModulus(encrypted, d, n);
-        if (decrypted > 255)
+        for (size_t group = 0; group < groups; group++)
         {
-            std::cerr << "⚠️  Warning: Decrypted value " << decrypted << " exceeds uint8_t range for n=" << n << "\n"
-                      << std::endl;
-            decrypted = decrypted % 256;
+#ifdef _OPENMP
+            if (group == 0)
+            {
+                printf("\033[1;36m🔵 [OpenMP (RSA)] Threads used for decryption: %d\033[0m\n", omp_get_num_threads());
+            }
+#endif
+            size_t first = group * GROUP_VALUES;
+            size_t groupCount = std::min(GROUP_VALUES, count - first);
+            if (packedBits)
+            {
+                size_t offset = first / 8 * packedBits;
+                unpackGroup(&data[offset], data.size() - offset, groupCount, packedBits, groupValues);
+            }
+            else
+            {
+                for (size_t i = 0; i < groupCount; i++)
+                {
+                    const uint8_t *word = &data[(first + i) * 4];
+                    groupValues[i] = (static_cast<uint32_t>(word[0]) << 24) |
+                                     (static_cast<uint32_t>(word[1]) << 16) |
+                                     (static_cast<uint32_t>(word[2]) << 8) |
+                                     static_cast<uint32_t>(word[3]);
+                }
+            }
+
+            for (size_t i = 0; i < groupCount; i++)
+            {
+                uint32_t encrypted = groupValues[i];
+                int cached = cache.find(encrypted);
+                if (cached >= 0)
+                {
+                    decryptedValues[first + i] = static_cast<uint8_t>(cached);
+                    continue;
+                }
+                int decrypted = crt ? crtPowerModulus(static_cast<int>(encrypted % n), crtKey)
+                                    : Utils::powerModulus(static_cast<int>(encrypted), d, n);
+                if (decrypted > 255)
+                {
+                    std::cerr << "⚠️  Warning: Decrypted value " << decrypted << " exceeds uint8_t range for n=" << n << "\n"
+                              << std::endl;
+                    decrypted = decrypted % 256;
+                }
+                else
+                {
+                    cache.insert(encrypted, static_cast<uint8_t>(decrypted));
+                }
+                decryptedValues[first + i] = static_cast<uint8_t>(decrypted);
+            }
         }
-        decryptedValues[i / 4] = static_cast<uint8_t>(decrypted);
     }
     auto end = std::chrono::high_resolution_clock::now();
-    printf("\033[1;32m🟢 [Timing] Decryption time: %lld ms\033[0m\n", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    printf("\033[1;32m🟢 [Timing] Decryption time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
     return decryptedValues;
 }
 
@@ -31,11 +31,16 @@ private:
     char* publicKey;  // Public key in String format
     char* privateKey;  // Private key in String format
 public:
+    static constexpr int PUBLIC_EXPONENT = 65537;
+
     Rsa(int p, int q);
     ~Rsa();
     ResultGenerateKeys generateKeys();
-    std::vector<uint8_t> encrypt(const std::vector<uint8_t>& data, const std::string& publicKey);
-    std::vector<uint8_t> decrypt(const std::vector<uint8_t>& data, const std::string& privateKey);
+    // packedBits 0 stores every ciphertext value in a 4-byte big-endian word; otherwise values are
+    // packed MSB-first at that many bits (at least cipherBits of the key), 8 values per packedBits bytes
+    std::vector<uint8_t> encrypt(const std::vector<uint8_t>& data, const std::string& publicKey, unsigned packedBits = 0);
+    std::vector<uint8_t> decrypt(const std::vector<uint8_t>& data, const std::string& privateKey, unsigned packedBits = 0);
+    static unsigned cipherBits(const std::string& key);
     char* getPublicKey();
     char* getPrivateKey();
     void setPublicKey(const char* publicKey);
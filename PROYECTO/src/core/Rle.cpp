@@ -0,0 +1,318 @@
+#include "Rle.h"
+#include <omp.h>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <unordered_map>
+
+Rle::Rle(unsigned unitSize) : unitSize(unitSize) {
+    /**
+     * Constructor for the Rle class
+     *
+     * @param unitSize: The size in bytes of the values that form runs (1 to 8)
+     *
+     * @return: None
+     */
+    if (unitSize < 1 || unitSize > 8) {
+        throw std::invalid_argument("❌ Error: RLE unit size must be between 1 and 8 bytes");
+    }
+}
+
+uint64_t Rle::loadUnit(const uint8_t *data, unsigned unitSize) {
+    /**
+     * Function to read one unit as an integer, so units compare with a single instruction
+     *
+     * @param data: The first byte of the unit
+     * @param unitSize: The size of the unit in bytes
+     *
+     * @return: The unit (its bytes in memory order, zero extended)
+     */
+    uint64_t unit = 0;
+    std::memcpy(&unit, data, unitSize);
+    return unit;
+}
+
+void Rle::writeCount(std::vector<uint8_t> &out, uint64_t count) {
+    /**
+     * Function to write the count of an escape sequence, 7 bits per byte (LEB128)
+     *
+     * @param out: The encoded stream
+     * @param count: The count to write
+     *
+     * @return: None
+     */
+    while (count >= 0x80) {
+        out.push_back(static_cast<uint8_t>(count | 0x80));
+        count >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(count));
+}
+
+bool Rle::readCount(const uint8_t *&in, const uint8_t *end, uint64_t &count) {
+    /**
+     * Function to read a count written by writeCount
+     *
+     * @param in: The read position, advanced past the count
+     * @param end: The end of the encoded stream
+     * @param count: Where the count is stored
+     *
+     * @return: false if the stream ends inside the count or the count does not fit 64 bits
+     */
+    count = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+        if (in >= end) return false;
+        uint8_t byte = *in++;
+        count |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+std::vector<std::pair<size_t, size_t>> Rle::sampleWindows(size_t size) const {
+    /**
+     * Function to pick the windows the statistics are sampled from: the whole input when it is
+     * small, otherwise SAMPLE_COUNT windows spread evenly over it
+     *
+     * @param size: The size of the input
+     *
+     * @return: The start and end of every window, aligned to the unit size
+     */
+    std::vector<std::pair<size_t, size_t>> windows;
+    size_t usable = size - size % unitSize;
+    if (usable <= SAMPLE_COUNT * SAMPLE_BYTES) {
+        windows.emplace_back(0, usable);
+        return windows;
+    }
+    for (size_t window = 0; window < SAMPLE_COUNT; ++window) {
+        size_t start = (usable - SAMPLE_BYTES) / (SAMPLE_COUNT - 1) * window;
+        start -= start % unitSize;
+        windows.emplace_back(start, start + SAMPLE_BYTES - SAMPLE_BYTES % unitSize);
+    }
+    return windows;
+}
+
+bool Rle::worthwhile(const std::vector<char> &data) const {
+    /**
+     * Function to estimate from a sample whether the transform pays off: it adds up the bytes
+     * the runs of the sampled windows would save and compares them with the sample size
+     *
+     * @param data: The data the transform would be applied to
+     *
+     * @return: true if the runs would save at least MIN_SAVED_FRACTION of the data
+     */
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    const size_t sequenceBytes = 2 * unitSize + 1;  // Escape, count and unit of a run
+    size_t sampledBytes = 0, savedBytes = 0;
+    for (const std::pair<size_t, size_t> &window : sampleWindows(data.size())) {
+        sampledBytes += window.second - window.first;
+        size_t position = window.first;
+        while (position < window.second) {
+            uint64_t unit = loadUnit(bytes + position, unitSize);
+            size_t runEnd = position + unitSize;
+            while (runEnd < window.second && loadUnit(bytes + runEnd, unitSize) == unit) runEnd += unitSize;
+            size_t runBytes = runEnd - position;
+            if (runBytes >= MIN_RUN * unitSize) savedBytes += runBytes - sequenceBytes;
+            position = runEnd;
+        }
+    }
+    return sampledBytes > 0 && savedBytes >= sampledBytes * MIN_SAVED_FRACTION;
+}
+
+uint64_t Rle::chooseEscape(const std::vector<char> &data) const {
+    /**
+     * Function to choose the escape unit: the rarest of the units 0 to 255 in the sample, so
+     * escaping units of the data themselves is rare
+     *
+     * @param data: The data to be transformed
+     *
+     * @return: The escape unit
+     */
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    std::unordered_map<uint64_t, size_t> frequencies;
+    for (const std::pair<size_t, size_t> &window : sampleWindows(data.size())) {
+        for (size_t position = window.first; position < window.second; position += unitSize) {
+            uint64_t unit = loadUnit(bytes + position, unitSize);
+            if (unit < 256) frequencies[unit]++;
+        }
+    }
+    uint64_t escape = 0;
+    size_t lowest = SIZE_MAX;
+    for (uint64_t candidate = 0; candidate < 256 && lowest > 0; ++candidate) {
+        auto found = frequencies.find(candidate);
+        size_t frequency = found == frequencies.end() ? 0 : found->second;
+        if (frequency < lowest) {
+            lowest = frequency;
+            escape = candidate;
+        }
+    }
+    return escape;
+}
+
+void Rle::encodeChunk(const uint8_t *data, size_t units, uint64_t escape, std::vector<uint8_t> &out) const {
+    /**
+     * Function to encode a range of whole units
+     *
+     * @param data: The first byte of the range
+     * @param units: The number of units in the range
+     * @param escape: The escape unit
+     * @param out: Where the encoded range is appended
+     *
+     * @return: None
+     */
+    uint8_t escapeBytes[8];
+    std::memcpy(escapeBytes, &escape, sizeof(escapeBytes));
+    size_t i = 0;
+    while (i < units) {
+        uint64_t unit = loadUnit(data + i * unitSize, unitSize);
+        size_t runEnd = i + 1;
+        while (runEnd < units && loadUnit(data + runEnd * unitSize, unitSize) == unit) runEnd++;
+        size_t run = runEnd - i;
+        if (run >= MIN_RUN) {
+            out.insert(out.end(), escapeBytes, escapeBytes + unitSize);
+            writeCount(out, run - MIN_RUN + 1);
+            out.insert(out.end(), data + i * unitSize, data + (i + 1) * unitSize);
+        } else if (unit == escape) {
+            for (size_t j = 0; j < run; ++j) {
+                out.insert(out.end(), escapeBytes, escapeBytes + unitSize);
+                out.push_back(0);
+            }
+        } else {
+            out.insert(out.end(), data + i * unitSize, data + runEnd * unitSize);
+        }
+        i = runEnd;
+    }
+}
+
+std::vector<char> Rle::compress(const std::vector<char> &data) const {
+    /**
+     * Function to apply the run-length transform. The input is cut into chunks encoded in
+     * parallel with OpenMP (runs are split at chunk boundaries); bytes after the last whole
+     * unit are stored as they are.
+     *
+     * @param data: The data to be transformed
+     *
+     * @return: The header (unit size, original size, escape unit) and the encoded stream
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    int numThreads = omp_get_max_threads();
+    printf("\033[1;36m🔵 [OpenMP (RLE)] Threads used for encoding: %d\033[0m\n", numThreads);
+
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    uint64_t escape = chooseEscape(data);
+    size_t units = data.size() / unitSize;
+    size_t chunkUnits = CHUNK_SIZE / unitSize;
+    size_t numChunks = (units + chunkUnits - 1) / chunkUnits;
+    std::vector<std::vector<uint8_t>> chunks(numChunks);
+    #pragma omp parallel for schedule(dynamic)
+    for (long long chunk = 0; chunk < static_cast<long long>(numChunks); ++chunk) {
+        size_t first = static_cast<size_t>(chunk) * chunkUnits;
+        size_t count = std::min(chunkUnits, units - first);
+        chunks[chunk].reserve(count * unitSize);
+        encodeChunk(bytes + first * unitSize, count, escape, chunks[chunk]);
+    }
+
+    std::vector<char> out;
+    out.push_back(static_cast<char>(unitSize));
+    for (unsigned i = 0; i < 8; ++i) out.push_back(static_cast<char>(static_cast<uint64_t>(data.size()) >> (8 * i)));
+    const char *escapeBytes = reinterpret_cast<const char *>(&escape);
+    out.insert(out.end(), escapeBytes, escapeBytes + unitSize);
+    for (const std::vector<uint8_t> &chunk : chunks) out.insert(out.end(), chunk.begin(), chunk.end());
+    out.insert(out.end(), data.begin() + units * unitSize, data.end());
+
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] RLE compress time: %lld ms (%zu -> %zu bytes)\033[0m\n",
+           static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()), data.size(), out.size());
+    return out;
+}
+
+std::vector<char> Rle::uncompress(const std::vector<char> &data) {
+    /**
+     * Function to undo the run-length transform. Stretches without escapes are copied with one
+     * memcpy and runs are expanded with memset (or by doubling memcpy for wider units).
+     *
+     * @param data: The output of compress
+     *
+     * @return: The original data (throws std::invalid_argument if the stream is corrupted)
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    if (data.size() < 9 || data[0] < 1 || data[0] > 8 || data.size() < 9 + static_cast<size_t>(data[0])) {
+        throw std::invalid_argument("❌ Error: Invalid RLE header");
+    }
+    const uint8_t *in = reinterpret_cast<const uint8_t *>(data.data());
+    const unsigned unitSize = in[0];
+    uint64_t outputSize = 0;
+    for (unsigned i = 0; i < 8; ++i) outputSize |= static_cast<uint64_t>(in[1 + i]) << (8 * i);
+    const uint8_t *escape = in + 9;
+    const uint8_t *end = in + data.size();
+    in = escape + unitSize;
+
+    std::vector<char> decoded(outputSize);
+    uint8_t *out = reinterpret_cast<uint8_t *>(decoded.data());
+    uint8_t *outEnd = out + outputSize;
+    bool valid = true;
+    while (valid && static_cast<size_t>(end - in) >= unitSize) {
+        if (std::memcmp(in, escape, unitSize) != 0) {
+            // Literal stretch up to the next escape unit
+            const uint8_t *next;
+            if (unitSize == 1) {
+                next = static_cast<const uint8_t *>(std::memchr(in, *escape, end - in));
+                if (!next) next = end;
+            } else {
+                next = in + unitSize;
+                while (static_cast<size_t>(end - next) >= unitSize && std::memcmp(next, escape, unitSize) != 0) next += unitSize;
+            }
+            size_t length = next - in;
+            if (length > static_cast<size_t>(outEnd - out)) {
+                valid = false;
+                break;
+            }
+            std::memcpy(out, in, length);
+            out += length;
+            in = next;
+            continue;
+        }
+
+        in += unitSize;
+        uint64_t count;
+        if (!readCount(in, end, count)) {
+            valid = false;
+            break;
+        }
+        const uint8_t *unit = escape;
+        uint64_t run = 1;
+        if (count > 0) {
+            if (static_cast<size_t>(end - in) < unitSize) {
+                valid = false;
+                break;
+            }
+            unit = in;
+            in += unitSize;
+            run = count + MIN_RUN - 1;
+        }
+        if (run > static_cast<size_t>(outEnd - out) / unitSize) {
+            valid = false;
+            break;
+        }
+        size_t runBytes = run * unitSize;
+        if (unitSize == 1) {
+            std::memset(out, *unit, runBytes);
+        } else {
+            std::memcpy(out, unit, unitSize);
+            for (size_t filled = unitSize; filled < runBytes; filled *= 2) {
+                std::memcpy(out + filled, out, std::min(filled, runBytes - filled));
+            }
+        }
+        out += runBytes;
+    }
+    // Bytes after the last whole unit
+    size_t tail = end - in;
+    if (!valid || tail != static_cast<size_t>(outEnd - out)) {
+        throw std::invalid_argument("❌ Error: Corrupted RLE stream");
+    }
+    std::memcpy(out, in, tail);
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] RLE uncompress time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start).count()));
+    return decoded;
+}
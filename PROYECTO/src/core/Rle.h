@@ -0,0 +1,37 @@
+#ifndef RLE_H
+#define RLE_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+// Run-length transform applied before the other stages. Data is read in units of 1 to 8 bytes
+// (4 for RSA ciphertext words); a run of MIN_RUN or more equal units becomes
+// escape, count, unit, and an escape unit that is part of the data becomes escape, 0.
+class Rle {
+private:
+    static constexpr size_t MIN_RUN = 4;  // Shortest run worth an escape sequence (in units)
+    static constexpr size_t CHUNK_SIZE = size_t(1) << 22;  // Input encoded by one thread
+    static constexpr size_t SAMPLE_COUNT = 64;     // Windows sampled by worthwhile
+    static constexpr size_t SAMPLE_BYTES = 4096;   // Size of every sampled window
+    static constexpr double MIN_SAVED_FRACTION = 1.0 / 8;
+
+    unsigned unitSize;
+
+    static uint64_t loadUnit(const uint8_t *data, unsigned unitSize);
+    static void writeCount(std::vector<uint8_t> &out, uint64_t count);
+    static bool readCount(const uint8_t *&in, const uint8_t *end, uint64_t &count);
+    std::vector<std::pair<size_t, size_t>> sampleWindows(size_t size) const;
+    uint64_t chooseEscape(const std::vector<char> &data) const;
+    void encodeChunk(const uint8_t *data, size_t units, uint64_t escape, std::vector<uint8_t> &out) const;
+public:
+    explicit Rle(unsigned unitSize = 1);
+    bool worthwhile(const std::vector<char> &data) const;
+    std::vector<char> compress(const std::vector<char> &data) const;
+    static std::vector<char> uncompress(const std::vector<char> &data);
+};
+
+#endif
@@ -0,0 +1,460 @@
+#include "Tans.h"
+#include "../helpers/BitStream.h"
+#include <omp.h>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+static unsigned highBit(uint32_t value) {
+    /**
+     * Function to find the position of the highest set bit
+     *
+     * @param value: A non-zero value
+     *
+     * @return: floor(log2(value))
+     */
+    return 31 - __builtin_clz(value);
+}
+
+Tans::Tans() : tableLog(DEFAULT_TABLE_LOG), normalized{}, symbolTransform{}, blockSize(DEFAULT_BLOCK_SIZE) {
+    /**
+     * Constructor for the Tans class
+     *
+     * @return: None
+     */
+}
+
+std::string Tans::getName() const {
+    /**
+     * Function to retrieve the name under which archives record this coder
+     *
+     * @return: "tans"
+     */
+    return "tans";
+}
+
+void Tans::setTableLog(unsigned log) {
+    /**
+     * Function to set the size of the state table used by the next buildModel call. Larger
+     * tables approximate the symbol probabilities more closely but take longer to build and
+     * leave less room in the CPU cache.
+     *
+     * @param log: The table holds 2^log states (MIN_TABLE_LOG to MAX_TABLE_LOG)
+     *
+     * @return: None
+     */
+    if (log < MIN_TABLE_LOG || log > MAX_TABLE_LOG) {
+        throw std::invalid_argument("❌ Error: tANS table log must be between " + std::to_string(MIN_TABLE_LOG) +
+                                    " and " + std::to_string(MAX_TABLE_LOG));
+    }
+    tableLog = log;
+}
+
+void Tans::buildModel(const FrequencyTable &frequencies) {
+    /**
+     * Function to build the coding tables from the byte frequencies
+     *
+     * @param frequencies: The frequency of every byte value, as counted by Histogram::count
+     *
+     * @return: None
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    normalizeFrequencies(frequencies);
+    buildEncodeTable();
+    auto end = std::chrono::high_resolution_clock::now();
+
+    printf("\033[1;32m🟢 [Timing] Building tANS tables time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+}
+
+void Tans::normalizeFrequencies(const FrequencyTable &frequencies) {
+    /**
+     * Function to scale the frequencies so they add up to the table size, giving every used
+     * symbol at least one slot. The scaled counts are rounded down and the slots left over
+     * (or missing, because of the minimum of one) go to the symbols where they change the
+     * encoded size the most.
+     *
+     * @param frequencies: The frequency of every byte value
+     *
+     * @return: None
+     */
+    std::fill(normalized, normalized + 256, 0);
+    uint64_t total = 0;
+    unsigned used = 0;
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        total += frequencies[symbol];
+        if (frequencies[symbol]) used++;
+    }
+    if (total == 0) return;
+    const uint32_t tableSize = 1u << tableLog;
+    if (used > tableSize) {
+        throw std::invalid_argument("❌ Error: tANS table log is too small for the number of symbols");
+    }
+
+    uint32_t assigned = 0;
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        if (!frequencies[symbol]) continue;
+        uint64_t scaled = static_cast<uint64_t>(static_cast<unsigned __int128>(frequencies[symbol]) * tableSize / total);
+        normalized[symbol] = static_cast<uint16_t>(std::max<uint64_t>(scaled, 1));
+        assigned += normalized[symbol];
+    }
+
+    // A symbol with n slots costs about frequency * log2(tableSize / n) bits
+    while (assigned < tableSize) {
+        int best = -1;
+        double bestGain = -1.0;
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            if (!normalized[symbol]) continue;
+            double gain = frequencies[symbol] * std::log2((normalized[symbol] + 1.0) / normalized[symbol]);
+            if (gain > bestGain) {
+                bestGain = gain;
+                best = symbol;
+            }
+        }
+        normalized[best]++;
+        assigned++;
+    }
+    while (assigned > tableSize) {
+        int best = -1;
+        double bestLoss = 0.0;
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            if (normalized[symbol] <= 1) continue;
+            double loss = frequencies[symbol] * std::log2(static_cast<double>(normalized[symbol]) / (normalized[symbol] - 1.0));
+            if (best < 0 || loss < bestLoss) {
+                bestLoss = loss;
+                best = symbol;
+            }
+        }
+        normalized[best]--;
+        assigned--;
+    }
+}
+
+std::vector<uint8_t> Tans::spreadSymbols() const {
+    /**
+     * Function to lay out the symbols over the states. Every symbol gets as many states as
+     * its normalized count, scattered with an odd step so that the states of one symbol are
+     * spread over the whole table. Encoder and decoder derive the same layout.
+     *
+     * @return: The symbol of every state
+     */
+    const uint32_t tableSize = 1u << tableLog;
+    const uint32_t mask = tableSize - 1;
+    const uint32_t step = (tableSize >> 1) + (tableSize >> 3) + 3;
+    std::vector<uint8_t> spread(tableSize, 0);
+    uint32_t position = 0;
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        for (unsigned i = 0; i < normalized[symbol]; ++i) {
+            spread[position] = static_cast<uint8_t>(symbol);
+            position = (position + step) & mask;
+        }
+    }
+    return spread;
+}
+
+void Tans::buildEncodeTable() {
+    /**
+     * Function to build the encoder tables. The encoder state lives in [tableSize, 2 * tableSize).
+     * Encoding a symbol first shifts out as many low bits as needed to bring the state into the
+     * symbol's range [n, 2n), then looks the next state up in the symbol's slice of stateTable.
+     *
+     * @return: None
+     */
+    const uint32_t tableSize = 1u << tableLog;
+    std::vector<uint8_t> spread = spreadSymbols();
+
+    uint32_t cumulative[257];
+    cumulative[0] = 0;
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        cumulative[symbol + 1] = cumulative[symbol] + normalized[symbol];
+    }
+    stateTable.assign(tableSize, 0);
+    uint32_t next[256];
+    std::copy(cumulative, cumulative + 256, next);
+    for (uint32_t state = 0; state < tableSize; ++state) {
+        stateTable[next[spread[state]]++] = static_cast<uint16_t>(tableSize + state);
+    }
+
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        uint32_t count = normalized[symbol];
+        if (count == 0) {
+            symbolTransform[symbol] = EncodeSymbol{0, 0};
+        } else if (count == 1) {
+            // Always emits tableLog bits
+            symbolTransform[symbol] = EncodeSymbol{static_cast<int32_t>(cumulative[symbol]) - 1, (tableLog << 16) - tableSize};
+        } else {
+            // States below minStatePlus emit one bit less than maxBitsOut
+            unsigned maxBitsOut = tableLog - highBit(count - 1);
+            uint32_t minStatePlus = count << maxBitsOut;
+            symbolTransform[symbol] = EncodeSymbol{static_cast<int32_t>(cumulative[symbol] - count), (maxBitsOut << 16) - minStatePlus};
+        }
+    }
+}
+
+void Tans::buildDecodeTable() {
+    /**
+     * Function to build the decoder table. Every state holds its symbol, the number of bits
+     * to read and the base of the next state, so a symbol is decoded with one lookup and one
+     * read.
+     *
+     * @return: None
+     */
+    const uint32_t tableSize = 1u << tableLog;
+    std::vector<uint8_t> spread = spreadSymbols();
+    uint32_t next[256];
+    std::copy(normalized, normalized + 256, next);
+    decodeTable.assign(tableSize, DecodeEntry{0, 0, 0});
+    for (uint32_t state = 0; state < tableSize; ++state) {
+        uint8_t symbol = spread[state];
+        uint32_t x = next[symbol]++;
+        unsigned nbBits = tableLog - highBit(x);
+        decodeTable[state] = DecodeEntry{static_cast<uint16_t>((x << nbBits) - tableSize), symbol, static_cast<uint8_t>(nbBits)};
+    }
+}
+
+std::vector<uint8_t> Tans::getTable() const {
+    /**
+     * Function to serialize the model: the table log followed by the 256 normalized counts,
+     * big-endian
+     *
+     * @return: The table that setTable (or uncompress) needs to decode the stream
+     */
+    std::vector<uint8_t> table;
+    table.reserve(TABLE_BYTES);
+    table.push_back(static_cast<uint8_t>(tableLog));
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        table.push_back(static_cast<uint8_t>(normalized[symbol] >> 8));
+        table.push_back(static_cast<uint8_t>(normalized[symbol] & 0xFF));
+    }
+    return table;
+}
+
+void Tans::setTable(const std::vector<uint8_t> &table) {
+    /**
+     * Function to load a model serialized by getTable
+     *
+     * @param table: The table log followed by the 256 normalized counts
+     *
+     * @return: None (throws std::invalid_argument if the table is not valid)
+     */
+    if (table.size() != TABLE_BYTES || table[0] < MIN_TABLE_LOG || table[0] > MAX_TABLE_LOG) {
+        throw std::invalid_argument("❌ Error: Invalid tANS table");
+    }
+    uint16_t counts[256];
+    uint32_t sum = 0;
+    for (int symbol = 0; symbol < 256; ++symbol) {
+        counts[symbol] = static_cast<uint16_t>((table[1 + 2 * symbol] << 8) | table[2 + 2 * symbol]);
+        sum += counts[symbol];
+    }
+    if (sum != 0 && sum != (1u << table[0])) {
+        throw std::invalid_argument("❌ Error: tANS normalized counts do not add up to the table size");
+    }
+    tableLog = table[0];
+    std::copy(counts, counts + 256, normalized);
+    buildEncodeTable();
+}
+
+std::vector<uint8_t> Tans::compress(const std::vector<char> &data) {
+    /**
+     * Function to compress a given set of data with tANS. Every block is encoded on its own
+     * thread into a byte-aligned buffer, and the buffers are then copied in parallel into
+     * the output at their prefix-sum offsets.
+     *
+     * @param data: The input data to be compressed
+     *
+     * @return: A vector containing the encoded blocks
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    int numThreads = omp_get_max_threads();
+    printf("\033[1;36m🔵 [OpenMP (tANS)] Threads used for compress: %d\033[0m\n", numThreads);
+
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data.data());
+    size_t numBlocks = (data.size() + blockSize - 1) / blockSize;
+    std::vector<std::vector<uint8_t>> encoded(numBlocks);
+    bool valid = true;
+    #pragma omp parallel for schedule(dynamic) reduction(&& : valid)
+    for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+        size_t first = static_cast<size_t>(block) * blockSize;
+        size_t last = std::min(first + blockSize, data.size());
+        for (size_t i = first; i < last; ++i) {
+            valid = valid && normalized[bytes[i]] != 0;
+        }
+        if (valid) encoded[block] = encodeBlock(bytes + first, last - first);
+    }
+    if (!valid) {
+        throw std::invalid_argument("❌ Error: Data holds a byte value that is not in the tANS model");
+    }
+
+    blocks.assign(numBlocks, CodedBlock{0, 0, false, {}});
+    uint64_t totalBytes = 0;
+    for (size_t block = 0; block < numBlocks; ++block) {
+        blocks[block] = CodedBlock{totalBytes * 8, block * blockSize, false, {}};
+        totalBytes += encoded[block].size();
+    }
+    std::vector<uint8_t> compressedData(totalBytes);
+    #pragma omp parallel for schedule(static)
+    for (long long block = 0; block < static_cast<long long>(numBlocks); ++block) {
+        std::memcpy(compressedData.data() + blocks[block].bitOffset / 8, encoded[block].data(), encoded[block].size());
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] Compress time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+    return compressedData;
+}
+
+std::vector<uint8_t> Tans::encodeBlock(const uint8_t *symbols, size_t count) const {
+    /**
+     * Function to encode one block. tANS encodes backwards, so the symbols are visited from
+     * last to first and the bits emitted for each one are kept in place. They are then
+     * written in symbol order after the final state, which is where the decoder starts.
+     *
+     * @param symbols: The symbols of the block (all of them present in the model)
+     * @param count: The number of symbols in the block
+     *
+     * @return: The encoded block, zero padded to a whole byte
+     */
+    const uint32_t tableSize = 1u << tableLog;
+    std::vector<uint32_t> emitted(count);  // Emitted bits << 8 | number of bits
+    uint32_t state = tableSize;
+    for (size_t i = count; i-- > 0;) {
+        const EncodeSymbol &transform = symbolTransform[symbols[i]];
+        uint32_t nbBits = (state + transform.deltaNbBits) >> 16;
+        emitted[i] = ((state & ((1u << nbBits) - 1)) << 8) | nbBits;
+        state = stateTable[(state >> nbBits) + transform.deltaFindState];
+    }
+
+    std::vector<uint8_t> out;
+    out.reserve(count * tableLog / 8 + 8);
+    BitWriter writer(out);
+    writer.write(state - tableSize, tableLog);
+    for (size_t i = 0; i < count; ++i) {
+        writer.write(emitted[i] >> 8, emitted[i] & 0xFF);
+    }
+    writer.flush();
+    return out;
+}
+
+void Tans::decodeBlock(const std::vector<uint8_t> &data, uint64_t bitOffset, char *output, size_t count) const {
+    /**
+     * Function to decode `count` symbols starting at a given bit of the stream. A refill
+     * leaves at least 56 bits, which covers several symbols of at most tableLog bits each.
+     *
+     * @param data: The encoded stream produced by compress
+     * @param bitOffset: The bit where the block (its initial state) starts
+     * @param output: Where the decoded symbols are written
+     * @param count: The number of symbols to decode
+     *
+     * @return: None (every state is valid, so any bit sequence decodes)
+     */
+    BitReader reader(data.data(), data.size(), bitOffset);
+    uint32_t state = static_cast<uint32_t>(reader.read(tableLog));
+    const unsigned symbolsPerRefill = 56 / tableLog;
+    const DecodeEntry *table = decodeTable.data();
+
+    // peek(tableLog) >> (tableLog - nbBits) reads nbBits bits, also when nbBits is 0
+    size_t i = 0;
+    for (; i + symbolsPerRefill <= count; i += symbolsPerRefill) {
+        reader.refill();
+        for (unsigned k = 0; k < symbolsPerRefill; ++k) {
+            const DecodeEntry &entry = table[state];
+            output[i + k] = static_cast<char>(entry.symbol);
+            state = entry.newState + static_cast<uint32_t>(reader.peek(tableLog) >> (tableLog - entry.nbBits));
+            reader.consume(entry.nbBits);
+        }
+    }
+    for (; i < count; ++i) {
+        reader.refill();
+        const DecodeEntry &entry = table[state];
+        output[i] = static_cast<char>(entry.symbol);
+        state = entry.newState + static_cast<uint32_t>(reader.peek(tableLog) >> (tableLog - entry.nbBits));
+        reader.consume(entry.nbBits);
+    }
+}
+
+std::vector<char> Tans::uncompress(const std::vector<uint8_t> &data, size_t outputSize,
+    const std::vector<uint8_t>* externalTable, const std::vector<CodedBlock>* externalBlocks) {
+    /**
+     * Function to decompress tANS encoded data. The blocks are decoded in parallel with
+     * OpenMP, each one straight into its place in the preallocated output.
+     *
+     * @param data: The encoded stream produced by compress
+     * @param outputSize: The number of symbols to decode
+     * @param externalTable: A pointer to a table serialized by getTable, if provided
+     * @param externalBlocks: A pointer to an external block index, if provided
+     *
+     * @return: A vector containing the decompressed data
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (externalTable) {
+        setTable(*externalTable);
+    }
+    if (externalBlocks) {
+        setBlocks(*externalBlocks);
+    }
+    if (outputSize && std::all_of(normalized, normalized + 256, [](uint16_t count) { return count == 0; })) {
+        throw std::invalid_argument("❌ Error: Empty tANS model for a non-empty stream");
+    }
+    buildDecodeTable();
+
+    std::vector<CodedBlock> index = blocks.empty() ? std::vector<CodedBlock>{CodedBlock{0, 0, false, {}}} : blocks;
+    for (size_t block = 0; block < index.size(); ++block) {
+        uint64_t nextOutput = block + 1 < index.size() ? index[block + 1].outputOffset : outputSize;
+        if (index[block].outputOffset > nextOutput || index[block].bitOffset > data.size() * 8ull || index[block].raw) {
+            throw std::invalid_argument("❌ Error: Invalid tANS block index");
+        }
+    }
+
+    std::vector<char> decoded(outputSize);
+    #pragma omp parallel for schedule(dynamic)
+    for (long long block = 0; block < static_cast<long long>(index.size()); ++block) {
+        uint64_t first = index[block].outputOffset;
+        uint64_t last = block + 1 < static_cast<long long>(index.size()) ? index[block + 1].outputOffset : outputSize;
+        decodeBlock(data, index[block].bitOffset, decoded.data() + first, last - first);
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] Uncompress time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+    return decoded;
+}
+
+std::vector<CodedBlock> Tans::getBlocks() const {
+    /**
+     * Function to retrieve the block index of the last compressed stream
+     *
+     * @return: The bit offset and output offset of every block
+     */
+    return blocks;
+}
+
+void Tans::setBlocks(const std::vector<CodedBlock> &blockIndex) {
+    /**
+     * Function to load the block index of a previously compressed stream
+     *
+     * @param blockIndex: The bit offset and output offset of every block
+     *
+     * @return: None
+     */
+    for (size_t block = 1; block < blockIndex.size(); ++block) {
+        if (blockIndex[block].bitOffset < blockIndex[block - 1].bitOffset ||
+            blockIndex[block].outputOffset < blockIndex[block - 1].outputOffset) {
+            throw std::invalid_argument("❌ Error: tANS block index must be in stream order");
+        }
+    }
+    blocks = blockIndex;
+}
+
+void Tans::setBlockSize(size_t size) {
+    /**
+     * Function to set how many symbols each independently decodable block holds
+     *
+     * @param size: The number of symbols per block
+     *
+     * @return: None
+     */
+    if (size == 0) {
+        throw std::invalid_argument("❌ Error: tANS block size must be greater than 0");
+    }
+    blockSize = size;
+}
@@ -0,0 +1,63 @@
+#ifndef TANS_H
+#define TANS_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "EntropyCoder.h"
+#include "../helpers/Histogram.h"
+
+class BitReader;
+
+class Tans : public EntropyCoder {
+private:
+    struct DecodeEntry {
+        uint16_t newState;  // Base of the next state, the bits read are added to it
+        uint8_t symbol;
+        uint8_t nbBits;     // Bits read to move to the next state
+    };
+
+    struct EncodeSymbol {
+        int32_t deltaFindState;  // Offset of the symbol's slice of stateTable
+        uint32_t deltaNbBits;    // Added to the state, its top 16 bits are the number of bits to emit
+    };
+
+    static constexpr unsigned MIN_TABLE_LOG = 5;
+    static constexpr unsigned MAX_TABLE_LOG = 15;  // States must fit in 16 bits
+    static constexpr size_t TABLE_BYTES = 1 + 256 * 2;  // Table log and 256 normalized counts
+
+    unsigned tableLog;
+    uint16_t normalized[256];  // Slots of every byte value in the state table, 0 if unused
+    std::vector<uint16_t> stateTable;  // Next encoder state, grouped by symbol
+    EncodeSymbol symbolTransform[256];
+    std::vector<DecodeEntry> decodeTable;
+    size_t blockSize;
+    std::vector<CodedBlock> blocks;
+
+    void normalizeFrequencies(const FrequencyTable &frequencies);
+    std::vector<uint8_t> spreadSymbols() const;
+    void buildEncodeTable();
+    void buildDecodeTable();
+    std::vector<uint8_t> encodeBlock(const uint8_t *symbols, size_t count) const;
+    void decodeBlock(const std::vector<uint8_t> &data, uint64_t bitOffset, char *output, size_t count) const;
+public:
+    static constexpr unsigned DEFAULT_TABLE_LOG = 12;
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1 << 17;
+
+    Tans();
+    std::string getName() const override;
+    void buildModel(const FrequencyTable &frequencies) override;
+    std::vector<uint8_t> getTable() const override;
+    void setTable(const std::vector<uint8_t> &table) override;
+    void setTableLog(unsigned log);
+    std::vector<CodedBlock> getBlocks() const override;
+    void setBlocks(const std::vector<CodedBlock> &blockIndex) override;
+    void setBlockSize(size_t size) override;
+    std::vector<uint8_t> compress(const std::vector<char> &data) override;
+    std::vector<char> uncompress(const std::vector<uint8_t> &data, size_t outputSize,
+        const std::vector<uint8_t>* externalTable = nullptr,
+        const std::vector<CodedBlock>* externalBlocks = nullptr) override;
+};
+
+#endif
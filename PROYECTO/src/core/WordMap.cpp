@@ -0,0 +1,140 @@
+#include "WordMap.h"
+#include <omp.h>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+static inline uint32_t loadWord(const char *data) {
+    /**
+     * Function to read a big-endian ciphertext word
+     *
+     * @param data: The first byte of the word
+     *
+     * @return: The word
+     */
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(data);
+    return (static_cast<uint32_t>(bytes[0]) << 24) | (static_cast<uint32_t>(bytes[1]) << 16) |
+           (static_cast<uint32_t>(bytes[2]) << 8) | bytes[3];
+}
+
+std::vector<uint32_t> WordMap::collectWords(const std::vector<char> &data) {
+    /**
+     * Function to collect the different words of the data, each thread scanning its own part
+     *
+     * @param data: The ciphertext (a whole number of words)
+     *
+     * @return: The words in increasing order, or MAX_WORDS + 1 words if there are more than MAX_WORDS
+     */
+    size_t numWords = data.size() / WORD_BYTES;
+    int numThreads = omp_get_max_threads();
+    std::vector<std::unordered_set<uint32_t>> threadWords(numThreads);
+    bool tooMany = false;
+    #pragma omp parallel
+    {
+        std::unordered_set<uint32_t> &words = threadWords[omp_get_thread_num()];
+        uint32_t last = 0;
+        bool haveLast = false;
+        #pragma omp for schedule(static)
+        for (long long i = 0; i < static_cast<long long>(numWords); ++i) {
+            uint32_t word = loadWord(data.data() + i * WORD_BYTES);
+            if (haveLast && word == last) continue;  // Runs are common, skip the hash lookup
+            last = word;
+            haveLast = true;
+            if (words.insert(word).second && words.size() > MAX_WORDS) {
+                #pragma omp atomic write
+                tooMany = true;
+            }
+        }
+    }
+    std::unordered_set<uint32_t> merged;
+    for (const std::unordered_set<uint32_t> &words : threadWords) merged.insert(words.begin(), words.end());
+    std::vector<uint32_t> dictionary(merged.begin(), merged.end());
+    if (tooMany || dictionary.size() > MAX_WORDS) {
+        dictionary.resize(MAX_WORDS + 1);
+        return dictionary;
+    }
+    std::sort(dictionary.begin(), dictionary.end());
+    return dictionary;
+}
+
+std::vector<char> WordMap::compress(const std::vector<char> &data) {
+    /**
+     * Function to replace every word by its index in the dictionary of the observed words
+     *
+     * @param data: The ciphertext
+     *
+     * @return: The number of words, the dictionary (big-endian words) and one index per word;
+     *          empty if the data is not a whole number of words with at most MAX_WORDS different
+     *          ones (the output of Rsa::encrypt always is)
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    if (data.size() % WORD_BYTES != 0) {
+        return {};
+    }
+    std::vector<uint32_t> dictionary = collectWords(data);
+    if (dictionary.size() > MAX_WORDS) {
+        return {};
+    }
+
+    size_t numWords = data.size() / WORD_BYTES;
+    size_t headerBytes = HEADER_BYTES + dictionary.size() * WORD_BYTES;
+    std::vector<char> out(headerBytes + numWords);
+    out[0] = static_cast<char>(dictionary.size() & 0xFF);
+    out[1] = static_cast<char>(dictionary.size() >> 8);
+    for (size_t i = 0; i < dictionary.size(); ++i) {
+        for (size_t byte = 0; byte < WORD_BYTES; ++byte) {
+            out[HEADER_BYTES + i * WORD_BYTES + byte] = static_cast<char>(dictionary[i] >> (8 * (WORD_BYTES - 1 - byte)));
+        }
+    }
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < static_cast<long long>(numWords); ++i) {
+        uint32_t word = loadWord(data.data() + i * WORD_BYTES);
+        out[headerBytes + i] = static_cast<char>(std::lower_bound(dictionary.begin(), dictionary.end(), word) - dictionary.begin());
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] Word map time: %lld ms (%zu words, %zu symbols)\033[0m\n",
+           static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()), numWords, dictionary.size());
+    return out;
+}
+
+std::vector<char> WordMap::uncompress(const std::vector<char> &data) {
+    /**
+     * Function to replace every index by its word
+     *
+     * @param data: The output of compress
+     *
+     * @return: The ciphertext (throws std::invalid_argument if the data is corrupted)
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    if (data.size() < HEADER_BYTES) {
+        throw std::invalid_argument("❌ Error: Invalid word map header");
+    }
+    size_t dictionarySize = static_cast<uint8_t>(data[0]) | (static_cast<size_t>(static_cast<uint8_t>(data[1])) << 8);
+    size_t headerBytes = HEADER_BYTES + dictionarySize * WORD_BYTES;
+    if (dictionarySize > MAX_WORDS || data.size() < headerBytes) {
+        throw std::invalid_argument("❌ Error: Invalid word map header");
+    }
+    const char *dictionary = data.data() + HEADER_BYTES;
+    size_t numWords = data.size() - headerBytes;
+
+    std::vector<char> out(numWords * WORD_BYTES);
+    bool valid = true;
+    #pragma omp parallel for schedule(static) reduction(&& : valid)
+    for (long long i = 0; i < static_cast<long long>(numWords); ++i) {
+        size_t index = static_cast<uint8_t>(data[headerBytes + i]);
+        if (index >= dictionarySize) {
+            valid = false;
+            continue;
+        }
+        std::copy(dictionary + index * WORD_BYTES, dictionary + (index + 1) * WORD_BYTES, out.begin() + i * WORD_BYTES);
+    }
+    if (!valid) {
+        throw std::invalid_argument("❌ Error: Corrupted word map stream");
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] Word unmap time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+    return out;
+}
@@ -0,0 +1,26 @@
+#ifndef WORD_MAP_H
+#define WORD_MAP_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// First stage for RSA ciphertext: every 4-byte big-endian word is one symbol, and a key has at
+// most 256 different words (one per plaintext byte), so each word is replaced by its index in
+// a dictionary of the observed words. The later stages and the entropy coder see one byte per
+// plaintext byte instead of four interleaved byte distributions.
+class WordMap {
+private:
+    static constexpr size_t WORD_BYTES = 4;
+    static constexpr size_t MAX_WORDS = 256;
+    static constexpr size_t HEADER_BYTES = 2;  // Number of dictionary words
+
+    static std::vector<uint32_t> collectWords(const std::vector<char> &data);
+public:
+    static std::vector<char> compress(const std::vector<char> &data);
+    static std::vector<char> uncompress(const std::vector<char> &data);
+};
+
+#endif
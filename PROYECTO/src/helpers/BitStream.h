@@ -0,0 +1,238 @@
+#ifndef BIT_STREAM_H
+#define BIT_STREAM_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+class BitWriter {
+private:
+    std::vector<uint8_t> &out;
+    uint64_t accumulator;  // Pending bits, left aligned (MSB first)
+    unsigned bitCount;     // Number of valid bits in the accumulator
+    uint64_t totalBits;
+
+    void storeWord(uint64_t word) {
+        /**
+         * Function to append a full 64-bit word to the output buffer in big-endian order
+         *
+         * @param word: The word to be stored
+         *
+         * @return: None
+         */
+        size_t pos = out.size();
+        out.resize(pos + sizeof(uint64_t));
+        word = __builtin_bswap64(word);
+        std::memcpy(out.data() + pos, &word, sizeof(uint64_t));
+    }
+
+public:
+    explicit BitWriter(std::vector<uint8_t> &out) : out(out), accumulator(0), bitCount(0), totalBits(0) {}
+
+    void write(uint64_t bits, unsigned length) {
+        /**
+         * Function to append the lowest `length` bits of `bits` to the stream, MSB first
+         *
+         * @param bits: The bits to be written, right aligned (bits above `length` must be zero)
+         * @param length: The number of bits to write (0 to 64)
+         *
+         * @return: None
+         */
+        if (length == 0) return;
+        totalBits += length;
+        unsigned freeBits = 64 - bitCount;
+        if (length < freeBits) {
+            accumulator |= bits << (freeBits - length);
+            bitCount += length;
+            return;
+        }
+
+        // The accumulator gets full: store it and keep the remaining bits
+        unsigned rest = length - freeBits;
+        accumulator |= bits >> rest;
+        storeWord(accumulator);
+        accumulator = rest ? bits << (64 - rest) : 0;
+        bitCount = rest;
+    }
+
+    void flush() {
+        /**
+         * Function to write the pending bits to the output buffer, padding the last byte with zeros
+         *
+         * @return: None
+         */
+        unsigned bytes = (bitCount + 7) / 8;
+        for (unsigned i = 0; i < bytes; ++i) {
+            out.push_back(static_cast<uint8_t>(accumulator >> (56 - 8 * i)));
+        }
+        accumulator = 0;
+        bitCount = 0;
+    }
+
+    uint64_t bitsWritten() const {
+        return totalBits;
+    }
+};
+
+class OffsetBitWriter {
+private:
+    uint8_t *out;
+    uint64_t bytePos;      // Byte where the accumulator will be stored
+    uint64_t firstByte;    // First byte touched by this writer
+    bool sharedHead;       // Whether the first byte also holds bits of the previous writer
+    uint64_t accumulator;  // Pending bits, left aligned (MSB first)
+    unsigned bitCount;     // Number of bits in the accumulator, including the leading offset
+
+    void storeByte(uint64_t index, uint8_t value, bool shared) {
+        /**
+         * Function to store one byte, merging it atomically when another writer owns part of it
+         *
+         * @param index: The byte index in the output buffer
+         * @param value: The bits of this writer in that byte (the others are zero)
+         * @param shared: Whether another writer may write the same byte concurrently
+         *
+         * @return: None
+         */
+        if (shared) __atomic_fetch_or(out + index, value, __ATOMIC_RELAXED);
+        else out[index] = value;
+    }
+
+public:
+    OffsetBitWriter(uint8_t *out, uint64_t bitOffset)
+        : out(out), bytePos(bitOffset / 8), firstByte(bitOffset / 8), sharedHead(bitOffset % 8 != 0),
+          accumulator(0), bitCount(bitOffset % 8) {}
+
+    void write(uint64_t bits, unsigned length) {
+        /**
+         * Function to append the lowest `length` bits of `bits` to the stream, MSB first
+         *
+         * @param bits: The bits to be written, right aligned (bits above `length` must be zero)
+         * @param length: The number of bits to write (0 to 64)
+         *
+         * @return: None
+         */
+        if (length == 0) return;
+        unsigned freeBits = 64 - bitCount;
+        if (length < freeBits) {
+            accumulator |= bits << (freeBits - length);
+            bitCount += length;
+            return;
+        }
+
+        unsigned rest = length - freeBits;
+        accumulator |= bits >> rest;
+        if (sharedHead && bytePos == firstByte) {
+            storeByte(bytePos, static_cast<uint8_t>(accumulator >> 56), true);
+            for (unsigned i = 1; i < 8; ++i) {
+                out[bytePos + i] = static_cast<uint8_t>(accumulator >> (56 - 8 * i));
+            }
+        } else {
+            uint64_t word = __builtin_bswap64(accumulator);
+            std::memcpy(out + bytePos, &word, sizeof(uint64_t));
+        }
+        bytePos += sizeof(uint64_t);
+        accumulator = rest ? bits << (64 - rest) : 0;
+        bitCount = rest;
+    }
+
+    void flush() {
+        /**
+         * Function to store the pending bits. The last byte is merged atomically when it is
+         * only partially filled, since the next writer starts inside it.
+         *
+         * @return: None
+         */
+        unsigned bytes = (bitCount + 7) / 8;
+        for (unsigned i = 0; i < bytes; ++i) {
+            bool shared = (sharedHead && bytePos + i == firstByte) || (i == bytes - 1 && bitCount % 8 != 0);
+            storeByte(bytePos + i, static_cast<uint8_t>(accumulator >> (56 - 8 * i)), shared);
+        }
+        bytePos += bytes;
+        accumulator = 0;
+        bitCount = 0;
+    }
+};
+
+class BitReader {
+private:
+    const uint8_t *data;
+    size_t size;
+    size_t bytePos;        // Next byte to be loaded into the buffer
+    uint64_t buffer;       // Loaded bits, left aligned (MSB first)
+    unsigned bitsInBuffer;
+
+public:
+    BitReader(const uint8_t *data, size_t size, uint64_t bitOffset = 0)
+        : data(data), size(size), bytePos(bitOffset / 8), buffer(0), bitsInBuffer(0) {
+        refill();
+        consume(bitOffset % 8);
+    }
+
+    void refill() {
+        /**
+         * Function to top up the bit buffer so that at least 56 bits are available to peek.
+         * Past the end of the input the stream reads as zeros.
+         *
+         * @return: None
+         */
+        if (bytePos + sizeof(uint64_t) <= size) {
+            uint64_t word;
+            std::memcpy(&word, data + bytePos, sizeof(uint64_t));
+            buffer |= __builtin_bswap64(word) >> bitsInBuffer;
+            unsigned bytes = (63 - bitsInBuffer) >> 3;
+            bytePos += bytes;
+            bitsInBuffer += bytes * 8;
+            return;
+        }
+        while (bitsInBuffer <= 56) {
+            uint64_t byte = bytePos < size ? data[bytePos] : 0;
+            buffer |= byte << (56 - bitsInBuffer);
+            bytePos++;
+            bitsInBuffer += 8;
+        }
+    }
+
+    uint64_t peek(unsigned length) const {
+        /**
+         * Function to look at the next `length` bits without consuming them
+         *
+         * @param length: The number of bits to look at (1 to 56)
+         *
+         * @return: The bits, right aligned
+         */
+        return buffer >> (64 - length);
+    }
+
+    void consume(unsigned length) {
+        /**
+         * Function to drop the next `length` bits from the buffer
+         *
+         * @param length: The number of bits to drop (0 to 56)
+         *
+         * @return: None
+         */
+        buffer <<= length;
+        bitsInBuffer -= length;
+    }
+
+    unsigned available() const {
+        return bitsInBuffer;
+    }
+
+    uint64_t read(unsigned length) {
+        /**
+         * Function to read and consume the next `length` bits
+         *
+         * @param length: The number of bits to read (1 to 56)
+         *
+         * @return: The bits, right aligned
+         */
+        refill();
+        uint64_t bits = peek(length);
+        consume(length);
+        return bits;
+    }
+};
+
+#endif
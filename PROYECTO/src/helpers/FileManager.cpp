@@ -169,6 +169,31 @@ ArchiveData FileManager::loadJsonFile(const std::string& filePath) {
     }
     archive.private_key = jsonData["private_key"].get<std::string>();
 
+    // Extract rsa_bits (absent in archives encrypted byte by byte)
+    if (jsonData.contains("rsa_bits")) {
+        if (!jsonData["rsa_bits"].is_number_unsigned()) {
+            throw std::runtime_error("❌ Error: Invalid JSON - invalid 'rsa_bits'");
+        }
+        archive.rsa_bits = jsonData["rsa_bits"].get<unsigned>();
+    }
+
+    // Extract cipher_bits (absent when ciphertext values are 4-byte words)
+    if (jsonData.contains("cipher_bits")) {
+        if (!jsonData["cipher_bits"].is_number_unsigned() || jsonData["cipher_bits"] > 32) {
+            throw std::runtime_error("❌ Error: Invalid JSON - invalid 'cipher_bits'");
+        }
+        archive.cipher_bits = jsonData["cipher_bits"].get<unsigned>();
+    }
+
+    // Extract bulk_cipher and session_key (hybrid archives only)
+    if (jsonData.contains("bulk_cipher")) {
+        if (!jsonData["bulk_cipher"].is_string() || !jsonData.contains("session_key") || !jsonData["session_key"].is_string()) {
+            throw std::runtime_error("❌ Error: Invalid JSON - invalid 'bulk_cipher' or 'session_key'");
+        }
+        archive.bulk_cipher = jsonData["bulk_cipher"].get<std::string>();
+        archive.session_key = jsonData["session_key"].get<std::string>();
+    }
+
     // Extract files
     if (!jsonData.contains("files") || !jsonData["files"].is_array()) {
         throw std::runtime_error("❌ Error: Invalid JSON - missing or invalid 'files' array");
@@ -194,22 +219,88 @@ ArchiveData FileManager::loadJsonFile(const std::string& filePath) {
         }
         fileEntry.file_data = fileEntryJson["file_data"].get<std::string>();
 
-        if (!fileEntryJson.contains("huffman_table") || !fileEntryJson["huffman_table"].is_array()) {
-            std::cerr << "⚠️  Warning: Missing or invalid 'huffman_table' in file entry\n" << std::endl;
+        if (!fileEntryJson.contains("original_size") || !fileEntryJson["original_size"].is_number_unsigned()) {
+            std::cerr << "⚠️  Warning: Missing or invalid 'original_size' in file entry\n" << std::endl;
             continue;
         }
-        for (const auto& tableEntry : fileEntryJson["huffman_table"]) {
-            if (!tableEntry.is_object() ||
-                !tableEntry.contains("letter") || !(tableEntry["letter"].is_number_unsigned()
-                    || tableEntry["letter"].is_number_integer()) ||
-                !tableEntry.contains("code") || !tableEntry["code"].is_string()) {
-                std::cerr << "⚠️  Warning: Skipping invalid Huffman table entry in '" << fileEntry.file_name << "'\n" << std::endl;
+        fileEntry.original_size = fileEntryJson["original_size"].get<size_t>();
+
+        // Archives written before the tANS backend are always Huffman coded
+        if (fileEntryJson.contains("entropy_coder")) {
+            if (!fileEntryJson["entropy_coder"].is_string() ||
+                (fileEntryJson["entropy_coder"] != "huffman" && fileEntryJson["entropy_coder"] != "huffman-o1" &&
+                 fileEntryJson["entropy_coder"] != "tans")) {
+                std::cerr << "⚠️  Warning: Invalid 'entropy_coder' in file entry\n" << std::endl;
+                continue;
+            }
+            fileEntry.entropy_coder = fileEntryJson["entropy_coder"].get<std::string>();
+        }
+
+        // Archives written before the transform stages entropy code the ciphertext directly
+        if (fileEntryJson.contains("transforms")) {
+            bool validTransforms = fileEntryJson["transforms"].is_array();
+            if (validTransforms) {
+                for (const auto &transform : fileEntryJson["transforms"]) {
+                    validTransforms = validTransforms && transform.is_string() && (transform == "words" || transform == "rle" ||
+                                                                            transform == "lz77" || transform == "bwt");
+                }
+            }
+            if (!validTransforms) {
+                std::cerr << "⚠️  Warning: Invalid 'transforms' in file entry\n" << std::endl;
+                continue;
+            }
+            fileEntry.transforms = fileEntryJson["transforms"].get<std::vector<std::string>>();
+        }
+
+        if (!fileEntryJson.contains("code_lengths") || !fileEntryJson["code_lengths"].is_string()) {
+            std::cerr << "⚠️  Warning: Missing or invalid 'code_lengths' in file entry\n" << std::endl;
+            continue;
+        }
+        fileEntry.code_lengths = fileEntryJson["code_lengths"].get<std::string>();
+
+        // Archives written before interleaved sub-streams have a single stream per block
+        if (fileEntryJson.contains("huffman_streams")) {
+            if (!fileEntryJson["huffman_streams"].is_number_unsigned() ||
+                (fileEntryJson["huffman_streams"] != 1 && fileEntryJson["huffman_streams"] != 4)) {
+                std::cerr << "⚠️  Warning: Invalid 'huffman_streams' in file entry\n" << std::endl;
+                continue;
+            }
+            fileEntry.huffman_streams = fileEntryJson["huffman_streams"].get<unsigned>();
+        }
+
+        if (fileEntryJson.contains("cipher_stream")) {
+            if (!fileEntryJson["cipher_stream"].is_number_unsigned()) {
+                std::cerr << "⚠️  Warning: Invalid 'cipher_stream' in file entry\n" << std::endl;
+                continue;
+            }
+            fileEntry.cipher_stream = fileEntryJson["cipher_stream"].get<uint32_t>();
+        }
+
+        if (!fileEntryJson.contains("block_bit_offsets") || !fileEntryJson["block_bit_offsets"].is_array() ||
+            !fileEntryJson.contains("block_output_offsets") || !fileEntryJson["block_output_offsets"].is_array() ||
+            fileEntryJson["block_bit_offsets"].size() != fileEntryJson["block_output_offsets"].size()) {
+            std::cerr << "⚠️  Warning: Missing or invalid block index in file entry\n" << std::endl;
+            continue;
+        }
+        fileEntry.block_bit_offsets = fileEntryJson["block_bit_offsets"].get<std::vector<uint64_t>>();
+        fileEntry.block_output_offsets = fileEntryJson["block_output_offsets"].get<std::vector<uint64_t>>();
+
+        // Per-block encodings are only written by the adaptive block mode
+        if (fileEntryJson.contains("block_raw") || fileEntryJson.contains("block_code_lengths")) {
+            if (!fileEntryJson.contains("block_raw") || !fileEntryJson["block_raw"].is_array() ||
+                !fileEntryJson.contains("block_code_lengths") || !fileEntryJson["block_code_lengths"].is_array() ||
+                fileEntryJson["block_raw"].size() != fileEntry.block_bit_offsets.size() ||
+                fileEntryJson["block_code_lengths"].size() != fileEntry.block_bit_offsets.size()) {
+                std::cerr << "⚠️  Warning: Invalid per-block encodings in file entry\n" << std::endl;
+                continue;
+            }
+            try {
+                fileEntry.block_raw = fileEntryJson["block_raw"].get<std::vector<bool>>();
+                fileEntry.block_code_lengths = fileEntryJson["block_code_lengths"].get<std::vector<std::string>>();
+            } catch (const json::exception &e) {
+                std::cerr << "⚠️  Warning: Invalid per-block encodings in file entry\n" << std::endl;
                 continue;
             }
-            int letterVal = tableEntry["letter"].get<int>();
-            char letter = static_cast<char>(letterVal);
-            std::string code = tableEntry["code"].get<std::string>();
-            fileEntry.huffman_table[code] = letter;
         }
         archive.files.push_back(fileEntry);
     }
@@ -17,12 +17,25 @@ using json = nlohmann::json;
 struct FileEntry {
     std::string file_name;
     std::string file_data;
-    std::unordered_map<std::string, char> huffman_table;
+    size_t original_size;
+    std::string entropy_coder = "huffman";  // Backend the entry was written with
+    std::vector<std::string> transforms;      // Stages applied before entropy coding, in order ("words", "rle", then "lz77" or "bwt")
+    std::string code_lengths;  // Base64 encoded table of the coder (code lengths for Huffman, context map and packed code lengths for order-1 Huffman, normalized counts for tANS)
+    unsigned huffman_streams = 1;  // Interleaved sub-streams per block
+    uint32_t cipher_stream = 0;    // Stream id of the entry under the session key (hybrid mode)
+    std::vector<uint64_t> block_bit_offsets;     // Where every independently decodable block starts
+    std::vector<uint64_t> block_output_offsets;  // Where the output of every block starts
+    std::vector<bool> block_raw;                  // Blocks stored uncompressed (empty for static archives)
+    std::vector<std::string> block_code_lengths;  // Base64 table of every block, "" for the file table
 };
 
 struct ArchiveData {
     std::string public_key;
     std::string private_key;
+    unsigned rsa_bits = 0;  // Modulus size of block RSA over the coded data, 0 for byte-wise RSA
+    unsigned cipher_bits = 0;  // Width byte-wise ciphertext values are packed at, 0 for 4-byte words
+    std::string bulk_cipher;   // Hybrid mode cipher ("aes-256-gcm" or "chacha20-poly1305"), empty for RSA only
+    std::string session_key;   // Base64 session key of the bulk cipher, wrapped with the RSA key
     std::vector<FileEntry> files;
 };
 
@@ -0,0 +1,183 @@
+#include "Histogram.h"
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <omp.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Every 32-bit sub-histogram is flushed before it can overflow
+static constexpr size_t SLICE_SIZE = size_t(1) << 30;
+// Below this size the parallel region costs more than it saves
+static constexpr size_t PARALLEL_THRESHOLD = size_t(1) << 16;
+
+bool Histogram::hasAvx2() {
+    /**
+     * Function to check at runtime whether the CPU supports AVX2
+     *
+     * @return: true if the AVX2 kernel can be used
+     */
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+void Histogram::countScalar(const uint8_t *data, size_t size, uint32_t (*subHistograms)[256]) {
+    /**
+     * Function to count bytes into SCALAR_SUB_HISTOGRAMS interleaved sub-histograms. Consecutive
+     * bytes go to different sub-histograms, so a run of equal bytes does not make every
+     * increment wait for the store of the previous one.
+     *
+     * @param data: The bytes to be counted
+     * @param size: The number of bytes
+     * @param subHistograms: SCALAR_SUB_HISTOGRAMS arrays of 256 counters, incremented in place
+     *
+     * @return: None
+     */
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(uint64_t));
+        subHistograms[0][word & 0xFF]++;
+        subHistograms[1][(word >> 8) & 0xFF]++;
+        subHistograms[2][(word >> 16) & 0xFF]++;
+        subHistograms[3][(word >> 24) & 0xFF]++;
+        subHistograms[0][(word >> 32) & 0xFF]++;
+        subHistograms[1][(word >> 40) & 0xFF]++;
+        subHistograms[2][(word >> 48) & 0xFF]++;
+        subHistograms[3][word >> 56]++;
+    }
+    for (; i < size; ++i) {
+        subHistograms[0][data[i]]++;
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+void Histogram::countAvx2(const uint8_t *data, size_t size, uint32_t (*subHistograms)[256]) {
+    /**
+     * Function to count bytes into AVX2_SUB_HISTOGRAMS interleaved sub-histograms, loading 32
+     * bytes per iteration. AVX2 has no scatter, so the increments stay scalar: the vector
+     * unit only widens the loads and the interleaving, which keeps more increments in
+     * flight than the scalar kernel.
+     *
+     * @param data: The bytes to be counted
+     * @param size: The number of bytes
+     * @param subHistograms: AVX2_SUB_HISTOGRAMS arrays of 256 counters, incremented in place
+     *
+     * @return: None
+     */
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        // A store instead of 64-bit lane extracts, which 32-bit x86 does not have
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        uint64_t words[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(words), block);
+        for (int w = 0; w < 4; ++w) {
+            uint64_t word = words[w];
+            for (int b = 0; b < 8; ++b) {
+                subHistograms[b][(word >> (8 * b)) & 0xFF]++;
+            }
+        }
+    }
+    countScalar(data + i, size - i, subHistograms);
+}
+#else
+void Histogram::countAvx2(const uint8_t *data, size_t size, uint32_t (*subHistograms)[256]) {
+    countScalar(data, size, subHistograms);
+}
+#endif
+
+FrequencyTable Histogram::countRange(const uint8_t *data, size_t size, bool useAvx2) {
+    /**
+     * Function to count a range of bytes on the calling thread, without any logging, so it
+     * can be used from inside parallel loops
+     *
+     * @param data: The bytes to be counted
+     * @param size: The number of bytes
+     * @param useAvx2: Whether to use the AVX2 kernel (the caller checks hasAvx2)
+     *
+     * @return: The frequency of every byte value
+     */
+    FrequencyTable table{};
+    unsigned subCount = useAvx2 ? AVX2_SUB_HISTOGRAMS : SCALAR_SUB_HISTOGRAMS;
+    uint32_t subHistograms[AVX2_SUB_HISTOGRAMS][256];
+    for (size_t slice = 0; slice < size; slice += SLICE_SIZE) {
+        size_t sliceSize = std::min(SLICE_SIZE, size - slice);
+        std::memset(subHistograms, 0, sizeof(subHistograms));
+        if (useAvx2) countAvx2(data + slice, sliceSize, subHistograms);
+        else countScalar(data + slice, sliceSize, subHistograms);
+        for (unsigned sub = 0; sub < subCount; ++sub) {
+            for (int symbol = 0; symbol < 256; ++symbol) {
+                table[symbol] += subHistograms[sub][symbol];
+            }
+        }
+    }
+    return table;
+}
+
+FrequencyTable Histogram::count(const uint8_t *data, size_t size, bool allowAvx2) {
+    /**
+     * Function to count how many times every byte value appears in the data. Every OpenMP
+     * thread counts a contiguous range into its own 32-bit sub-histograms, which are then
+     * summed into one 64-bit table.
+     *
+     * @param data: The bytes to be counted
+     * @param size: The number of bytes
+     * @param allowAvx2: Whether the AVX2 kernel may be used when the CPU supports it
+     *
+     * @return: The frequency of every byte value
+     */
+    auto start = std::chrono::high_resolution_clock::now();
+    bool useAvx2 = allowAvx2 && hasAvx2();
+    int numThreads = size >= PARALLEL_THRESHOLD ? omp_get_max_threads() : 1;
+    printf("\033[1;36m🔵 [OpenMP (Huffman)] Threads used for create frequency map of characters: %d (%s kernel)\033[0m\n",
+           numThreads, useAvx2 ? "AVX2" : "scalar");
+
+    std::vector<FrequencyTable> threadTables(numThreads, FrequencyTable{});
+    #pragma omp parallel num_threads(numThreads)
+    {
+        int threadId = omp_get_thread_num();
+        int threads = omp_get_num_threads();
+        size_t first = size * threadId / threads;
+        size_t last = size * (threadId + 1) / threads;
+        threadTables[threadId] = countRange(data + first, last - first, useAvx2);
+    }
+
+    FrequencyTable frequencies{};
+    for (const FrequencyTable &table : threadTables) {
+        for (int symbol = 0; symbol < 256; ++symbol) {
+            frequencies[symbol] += table[symbol];
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    printf("\033[1;32m🟢 [Timing] Creation frequency map time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
+
+    return frequencies;
+}
+
+FrequencyTable Histogram::count(const std::vector<char> &data) {
+    /**
+     * Function to count how many times every byte value appears in a char vector
+     *
+     * @param data: The data to be counted
+     *
+     * @return: The frequency of every byte value
+     */
+    return count(reinterpret_cast<const uint8_t *>(data.data()), data.size());
+}
+
+FrequencyTable Histogram::count(const std::vector<uint8_t> &data) {
+    /**
+     * Function to count how many times every byte value appears in a byte vector
+     *
+     * @param data: The data to be counted
+     *
+     * @return: The frequency of every byte value
+     */
+    return count(data.data(), data.size());
+}
@@ -0,0 +1,26 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+using FrequencyTable = std::array<uint64_t, 256>;
+
+class Histogram {
+private:
+    static void countScalar(const uint8_t *data, size_t size, uint32_t (*subHistograms)[256]);
+    static void countAvx2(const uint8_t *data, size_t size, uint32_t (*subHistograms)[256]);
+public:
+    static constexpr unsigned SCALAR_SUB_HISTOGRAMS = 4;
+    static constexpr unsigned AVX2_SUB_HISTOGRAMS = 8;
+
+    static bool hasAvx2();
+    static FrequencyTable countRange(const uint8_t *data, size_t size, bool useAvx2);
+    static FrequencyTable count(const uint8_t *data, size_t size, bool allowAvx2 = true);
+    static FrequencyTable count(const std::vector<char> &data);
+    static FrequencyTable count(const std::vector<uint8_t> &data);
+};
+
+#endif
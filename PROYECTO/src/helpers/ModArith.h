@@ -0,0 +1,216 @@
+#ifndef MOD_ARITH_H
+#define MOD_ARITH_H
+
+#include <cstdint>
+#include <stdexcept>
+
+// Modular arithmetic over 64-bit moduli with 128-bit intermediates. Products are reduced with
+// Montgomery multiplication (odd moduli) or Barrett reduction (any modulus), so exponentiation
+// needs no hardware divide after the one-time setup of the modulus.
+using uint128_t = unsigned __int128;
+
+class Montgomery64 {
+private:
+    uint64_t n;
+    uint64_t nInverse;  // n^-1 mod 2^64
+    uint64_t one;       // 2^64 mod n, the Montgomery form of 1
+    uint64_t r2;        // 2^128 mod n, converts into Montgomery form
+
+public:
+    explicit Montgomery64(uint64_t modulus) : n(modulus) {
+        /**
+         * Constructor for the Montgomery64 class
+         *
+         * @param modulus: The odd modulus (greater than 1)
+         *
+         * @return: None
+         */
+        if (modulus < 3 || (modulus & 1) == 0) {
+            throw std::invalid_argument("❌ Error: Montgomery reduction needs an odd modulus greater than 1");
+        }
+        // Newton's iteration doubles the correct low bits of the inverse at every step
+        nInverse = n;
+        for (int i = 0; i < 5; ++i) nInverse *= 2 - n * nInverse;
+        one = static_cast<uint64_t>((static_cast<uint128_t>(1) << 64) % n);
+        r2 = static_cast<uint64_t>(static_cast<uint128_t>(one) * one % n);
+    }
+
+    uint64_t reduce(uint128_t value) const {
+        /**
+         * Function to compute value * 2^-64 mod n (Montgomery reduction)
+         *
+         * @param value: A value below n * 2^64
+         *
+         * @return: The reduced value, below n
+         */
+        uint64_t m = static_cast<uint64_t>(value) * nInverse;
+        uint64_t high = static_cast<uint64_t>(value >> 64);
+        uint64_t correction = static_cast<uint64_t>((static_cast<uint128_t>(m) * n) >> 64);
+        // The low halves of value and m * n are equal, so only the high halves are subtracted
+        return high >= correction ? high - correction : high - correction + n;
+    }
+
+    uint64_t toMontgomery(uint64_t value) const {
+        return reduce(static_cast<uint128_t>(value % n) * r2);
+    }
+
+    uint64_t fromMontgomery(uint64_t value) const {
+        return reduce(value);
+    }
+
+    uint64_t multiply(uint64_t a, uint64_t b) const {
+        /**
+         * Function to multiply two values in Montgomery form
+         *
+         * @param a: The first factor, below n
+         * @param b: The second factor, below n
+         *
+         * @return: The product in Montgomery form
+         */
+        return reduce(static_cast<uint128_t>(a) * b);
+    }
+
+    uint64_t power(uint64_t base, uint64_t exponent) const {
+        /**
+         * Function to compute base^exponent mod n by square-and-multiply in Montgomery form
+         *
+         * @param base: The base value
+         * @param exponent: The exponent value
+         *
+         * @return: base^exponent mod n
+         */
+        uint64_t result = one;
+        uint64_t square = toMontgomery(base);
+        while (exponent > 0) {
+            if (exponent & 1) result = multiply(result, square);
+            square = multiply(square, square);
+            exponent >>= 1;
+        }
+        return fromMontgomery(result);
+    }
+};
+
+class Barrett64 {
+private:
+    uint64_t n;
+    uint128_t mu;  // floor((2^128 - 1) / n)
+
+public:
+    explicit Barrett64(uint64_t modulus) : n(modulus) {
+        /**
+         * Constructor for the Barrett64 class
+         *
+         * @param modulus: The modulus (greater than 0)
+         *
+         * @return: None
+         */
+        if (modulus == 0) {
+            throw std::invalid_argument("❌ Error: Barrett reduction needs a modulus greater than 0");
+        }
+        mu = ~static_cast<uint128_t>(0) / n;
+    }
+
+    uint64_t reduce(uint128_t value) const {
+        /**
+         * Function to compute value mod n. The quotient estimate is the high half of the
+         * 256-bit product value * mu, which is at most two below the true quotient.
+         *
+         * @param value: Any 128-bit value
+         *
+         * @return: value mod n
+         */
+        uint64_t v0 = static_cast<uint64_t>(value), v1 = static_cast<uint64_t>(value >> 64);
+        uint64_t m0 = static_cast<uint64_t>(mu), m1 = static_cast<uint64_t>(mu >> 64);
+        uint128_t p00 = static_cast<uint128_t>(v0) * m0;
+        uint128_t p01 = static_cast<uint128_t>(v0) * m1;
+        uint128_t p10 = static_cast<uint128_t>(v1) * m0;
+        uint128_t p11 = static_cast<uint128_t>(v1) * m1;
+        uint128_t middle = (p00 >> 64) + static_cast<uint64_t>(p01) + static_cast<uint64_t>(p10);
+        uint128_t quotient = p11 + (p01 >> 64) + (p10 >> 64) + (middle >> 64);
+
+        uint128_t remainder = value - quotient * n;
+        while (remainder >= n) remainder -= n;
+        return static_cast<uint64_t>(remainder);
+    }
+
+    uint64_t multiply(uint64_t a, uint64_t b) const {
+        return reduce(static_cast<uint128_t>(a) * b);
+    }
+
+    uint64_t power(uint64_t base, uint64_t exponent) const {
+        /**
+         * Function to compute base^exponent mod n by square-and-multiply
+         *
+         * @param base: The base value
+         * @param exponent: The exponent value
+         *
+         * @return: base^exponent mod n
+         */
+        uint64_t result = reduce(1);
+        uint64_t square = reduce(base);
+        while (exponent > 0) {
+            if (exponent & 1) result = multiply(result, square);
+            square = multiply(square, square);
+            exponent >>= 1;
+        }
+        return result;
+    }
+};
+
+class ModArith {
+public:
+    static uint64_t power(uint64_t base, uint64_t exponent, uint64_t modulus) {
+        /**
+         * Function to compute base^exponent mod modulus, through Montgomery multiplication for
+         * odd moduli (every RSA modulus) and Barrett reduction otherwise
+         *
+         * @param base: The base value
+         * @param exponent: The exponent value
+         * @param modulus: The modulus (greater than 0)
+         *
+         * @return: base^exponent mod modulus
+         */
+        if (modulus == 1) return 0;
+        if (modulus & 1) return Montgomery64(modulus).power(base, exponent);
+        return Barrett64(modulus).power(base, exponent);
+    }
+
+    static bool isPrime(uint64_t n) {
+        /**
+         * Function to test primality with the Miller-Rabin test. The first 12 primes as bases
+         * make the test deterministic for every 64-bit number.
+         *
+         * @param n: The number to test
+         *
+         * @return: true if n is prime
+         */
+        static constexpr uint64_t BASES[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+        if (n < 2) return false;
+        for (uint64_t prime : BASES) {
+            if (n % prime == 0) return n == prime;
+        }
+
+        // n - 1 = d * 2^s with d odd
+        uint64_t d = n - 1;
+        unsigned s = 0;
+        while ((d & 1) == 0) {
+            d >>= 1;
+            s++;
+        }
+        Montgomery64 montgomery(n);
+        const uint64_t minusOne = montgomery.toMontgomery(n - 1);
+        for (uint64_t base : BASES) {
+            uint64_t x = montgomery.toMontgomery(montgomery.power(base, d));
+            if (x == montgomery.toMontgomery(1) || x == minusOne) continue;
+            bool composite = true;
+            for (unsigned i = 1; i < s && composite; i++) {
+                x = montgomery.multiply(x, x);
+                composite = x != minusOne;
+            }
+            if (composite) return false;
+        }
+        return true;
+    }
+};
+
+#endif
@@ -1,8 +1,9 @@
 #include "Utils.h"
+#include "ModArith.h"
+#include <openssl/rand.h>
+#include <numeric>
 #include <unordered_map>
 #include <vector>
-#include <omp.h>
-#include <chrono>
 
 using std::vector;
 using std::string;
@@ -57,7 +58,8 @@ void Utils::freeCString(char* str) {
 
 int Utils::powerModulus(int base, int expo, int m) {
     /**
-     * Function to compute base^expo mod m
+     * Function to compute base^expo mod m, reducing the products with Montgomery
+     * multiplication or Barrett reduction (see ModArith.h) instead of a divide per step
      * 
      * @param base: The base value
      * @param expo: The exponent value
@@ -65,40 +67,91 @@ int Utils::powerModulus(int base, int expo, int m) {
      * 
      * @return: The result of base^expo mod m
      */
-
-    // if (m == 1) return 0; // Anything mod 1 is always 0
-
-    int result = 1;
-    // Base reduced to prevent overflow
-    base = base % m;
-
-    while (expo > 0) {
-        // If expo is odd, multiply base with result
-        if (expo & 1)
-            result = (result * 1LL * base) % m;
-
-        base = (base * 1LL * base) % m; // Square the base
-        expo = expo / 2; // Divide the expo by 2
+    if (m <= 0) {
+        throw std::invalid_argument("❌ Error: Modulus must be positive");
     }
+    if (expo <= 0) return 1 % m;
 
-    return result;
+    // Base reduced into [0, m) so negative bases work too
+    long long reduced = base % m;
+    if (reduced < 0) reduced += m;
+    return static_cast<int>(ModArith::power(static_cast<uint64_t>(reduced), static_cast<uint64_t>(expo), static_cast<uint64_t>(m)));
 }
 
 int Utils::modInverse(int e, int phi) {
     /**
-     * Function to find modular inverse of e modulo phi(n) where 1 < e < phi(n) 
+     * Function to find modular inverse of e modulo phi(n) with the extended Euclidean algorithm
      * 
      * @param e: The number for which the inverse is to be found
      * @param phi: The modulus value
      * 
-     * @return: The modular inverse of e modulo phi(n)
+     * @return: The modular inverse of e modulo phi(n), or -1 if gcd(e, phi) != 1
      */
-    for (int d = 2; d < phi; d++) {
-        // If e * d is congruent to 1 modulo phi, then d is the modular inverse of e
-        if ((e * d) % phi == 1)
-            return d;
+    if (phi < 2) return -1;
+
+    // Invariant: remainder == coefficient * e (mod phi) for both pairs
+    long long remainder = phi, nextRemainder = ((e % phi) + phi) % phi;
+    long long coefficient = 0, nextCoefficient = 1;
+    while (nextRemainder != 0) {
+        long long quotient = remainder / nextRemainder;
+        remainder -= quotient * nextRemainder;
+        coefficient -= quotient * nextCoefficient;
+        std::swap(remainder, nextRemainder);
+        std::swap(coefficient, nextCoefficient);
+    }
+    if (remainder != 1) return -1;
+    return static_cast<int>(coefficient < 0 ? coefficient + phi : coefficient);
+}
+
+bool Utils::isPrime(long long n) {
+    /**
+     * Function to test whether a number is prime (deterministic Miller-Rabin, see ModArith.h)
+     * 
+     * @param n: The number to test
+     * 
+     * @return: true if n is prime
+     */
+    return n > 1 && ModArith::isPrime(static_cast<uint64_t>(n));
+}
+
+uint64_t Utils::randomNumber(uint64_t bound) {
+    /**
+     * Function to draw a uniform random number from the OpenSSL generator
+     * 
+     * @param bound: The exclusive upper bound (greater than 0)
+     * 
+     * @return: A random number in [0, bound)
+     */
+    if (bound == 0) {
+        throw std::invalid_argument("❌ Error: Random bound must be positive");
+    }
+    // Values at or above the largest multiple of bound are drawn again, so every result is equally likely
+    const uint64_t limit = UINT64_MAX - UINT64_MAX % bound;
+    uint64_t value;
+    do {
+        if (RAND_bytes(reinterpret_cast<unsigned char *>(&value), sizeof(value)) != 1) {
+            throw std::runtime_error("❌ Error: Random number generation failed");
+        }
+    } while (value >= limit);
+    return value % bound;
+}
+
+int Utils::randomPrime(unsigned bits) {
+    /**
+     * Function to generate a random prime with exactly the given number of bits
+     * 
+     * @param bits: The size of the prime in bits (between 3 and 30)
+     * 
+     * @return: A random prime in [2^(bits - 1), 2^bits)
+     */
+    if (bits < 3 || bits > 30) {
+        throw std::invalid_argument("❌ Error: Prime size must be between 3 and 30 bits");
+    }
+    // Primes are dense enough (about 1 in 0.35 * bits odd numbers) that a few tries suffice
+    while (true) {
+        int candidate = static_cast<int>((1ULL << (bits - 1)) | randomNumber(1ULL << (bits - 1)) | 1);
+        if (isPrime(candidate)) return candidate;
     }
-    return -1;
 }
 
 
@@ -245,40 +298,3 @@ std::vector<int> Utils::base64ToNumbers(const char* base64CStr) {
     // Deserialize the binary data into a vector of integers
     return Utils::deserializeNumbers(binaryData);
 }
-
-std::unordered_map<char, int> Utils::createFreqMap(const std::vector<char>& data) {
-    /**
-     * Function to create a frequency map of characters in a given data using OpenMP
-     * 
-     * @param data: The data to create the frequency map from
-     * 
-     * @return: The frequency map of characters in the input data
-     */
-    auto start = std::chrono::high_resolution_clock::now();
-    int numThreads = omp_get_max_threads();
-    std::vector<std::unordered_map<char, int>> threadMaps(numThreads);
-    printf("\033[1;36m🔵 [OpenMP (Huffman)] Threads used for create frequency map of characters: %d\033[0m\n", numThreads);
-
-    #pragma omp parallel
-    {
-        int threadId = omp_get_thread_num();
-        auto& localMap = threadMaps[threadId];
-
-        #pragma omp for
-        for (size_t i = 0; i < data.size(); ++i) {
-            localMap[data[i]]++;
-        }
-    }
-
-    // Merge all local maps into a global map
-    std::unordered_map<char, int> freqMap;
-    for (const auto& localMap : threadMaps) {
-        for (const auto& pair : localMap) {
-            freqMap[pair.first] += pair.second;
-        }
-    }
-    auto end = std::chrono::high_resolution_clock::now();
-    printf("\033[1;32m🟢 [Timing] Creation frequency map time: %lld ms\033[0m\n", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
-
-    return freqMap;
-}
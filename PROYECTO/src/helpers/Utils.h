@@ -23,13 +23,15 @@ public:
     static void freeCString(char* str);
     static int powerModulus(int base, int expo, int m);
     static int modInverse(int e, int phi);
+    static bool isPrime(long long n);
+    static uint64_t randomNumber(uint64_t bound);
+    static int randomPrime(unsigned bits);
     static std::vector<uint8_t> serializeNumbers(const std::vector<int>& numbers);
     static std::vector<int> deserializeNumbers(const std::vector<uint8_t>& binaryData);
     static std::string binaryToBase64(const std::vector<uint8_t>& binaryData);
     static std::vector<uint8_t> base64ToBinary(const std::string& base64Str);
     static char* numbersToBase64(const std::vector<int>& numbers);
     static std::vector<int> base64ToNumbers(const char* base64CStr);
-    static std::unordered_map<char, int> createFreqMap(const std::vector<char>& data);
 };
 
 #endif // UTILS_H
@@ -1,7 +1,15 @@
 #include <iostream>
 #include <cstring>
 #include "./core/RSA.h"
+#include "./core/BigRsa.h"
+#include "./core/BulkCipher.h"
 #include "./core/Huffman.h"
+#include "./core/Tans.h"
+#include "./core/ContextHuffman.h"
+#include "./core/Lz77.h"
+#include "./core/Rle.h"
+#include "./core/Bwt.h"
+#include "./core/WordMap.h"
 #include "./helpers/Utils.h"
 #include "./helpers/FileManager.h"
 #include <cstdlib>
@@ -9,6 +17,7 @@
 #include <chrono>
 #include <regex>
 #include <filesystem>
+#include <memory>
 
 using json = nlohmann::json;
 
@@ -28,6 +37,27 @@ using json = nlohmann::json;
 #define FILE_EMOJI "📄"
 #define FOLDER_EMOJI "📁"
 
+// Size of each random prime when PRIME1 and PRIME2 are not set
+constexpr unsigned PRIME_BITS = 15;
+
+struct CompressionOptions
+{
+    std::string coder = "huffman";  // Entropy coder backend: 'huffman', 'huffman-o1' or 'tans'
+    unsigned maxCodeLength = 0;  // 0 means unlimited
+    bool adaptiveBlocks = true;  // Per-block table or raw fallback instead of one table per file
+    unsigned streams = 4;        // Huffman sub-streams per block (1 or 4)
+    bool wordSymbols = true;     // One symbol per RSA ciphertext word instead of four bytes
+    std::string packCipher = "auto";  // Ciphertext values at ceil(log2 n) bits without word symbols: 'auto' (when no LZ77/BWT stage runs), 'on' or 'off'
+    std::string level = "normal";  // 'normal' (LZ77) or 'high' (Burrows-Wheeler, slower but smaller)
+    size_t bwtBlock = Bwt::DEFAULT_BLOCK_SIZE;
+    std::string rle = "auto";    // Run-length stage: 'auto' (when a sample says it pays off), 'on' or 'off'
+    bool lz77 = true;            // LZ77 stage in front of the entropy coder
+    size_t lzWindow = Lz77::DEFAULT_WINDOW_SIZE;
+    unsigned lzDepth = Lz77::DEFAULT_SEARCH_DEPTH;
+    unsigned rsaBits = 0;        // Block RSA modulus size (2048, 3072 or 4096) over the coded data, 0 for byte-wise RSA
+    std::string cipher = "rsa";  // 'rsa', or a bulk cipher ('aes-256-gcm', 'chacha20-poly1305') under an RSA-wrapped session key
+};
+
 void printUsage(const char *programName)
 {
     /**
@@ -59,10 +89,30 @@ void printHelp(const char *programName)
     std::cout << "  --compress, -c     📦 Compress a file\n";
     std::cout << "  --decompress, -d   📥 Decompress a file\n";
     std::cout << "  --show, -s         👁️  Show the inner files of a compressed file\n";
+    std::cout << "  --benchmark, -b    ⏱️  Compare the entropy coders on the same input (accepts the compression options)\n";
+    std::cout << "\n⚙️  Compression Options:\n";
+    std::cout << "  --coder NAME         🧮 Entropy coder: 'huffman' (default), 'huffman-o1' (one table per previous byte) or 'tans'\n";
+    std::cout << "  --max-code-length N  ✂️  Cap Huffman codes at N bits (8-56), reports the ratio loss\n";
+    std::cout << "  --streams N          🔀 Interleaved Huffman sub-streams per block, 1 or 4 (default 4, faster decoding)\n";
+    std::cout << "  --block-mode MODE    🧱 'adaptive' (default) picks a table or raw storage per block, 'static' uses one table\n";
+    std::cout << "  --word-symbols on|off 🔤 Code every 4-byte ciphertext word as one byte-sized symbol (default on)\n";
+    std::cout << "  --pack-cipher auto|on|off 🗜️  Without word symbols, pack ciphertext values at ceil(log2 n) bits instead of 4 bytes (default auto: when no LZ77/BWT stage runs)\n";
+    std::cout << "  --level normal|high  🏆 'high' replaces LZ77 by a Burrows-Wheeler + move-to-front stage: smaller text archives, slower\n";
+    std::cout << "  --bwt-block BYTES    🧩 Block size of the 'high' level (1024-16777216, default 4194304)\n";
+    std::cout << "  --rle auto|on|off    🏃 Collapse runs of repeated ciphertext words first (default auto: when a sample shows enough runs)\n";
+    std::cout << "  --lz77 on|off        🔁 Replace repeated byte strings by back-references before entropy coding (default on)\n";
+    std::cout << "  --lz-window BYTES    🪟 How far back LZ77 matches can start, a power of two (1024-16777216, default 1048576)\n";
+    std::cout << "  --lz-depth N         🔎 Earlier positions tried per LZ77 match (default 32, higher is slower but smaller)\n";
+    std::cout << "  --rsa-bits N         🔐 Compress first, then encrypt padded blocks with an N-bit RSA key (2048, 3072 or 4096; default 0, byte-wise RSA)\n";
+    std::cout << "  --cipher NAME        🔑 'rsa' (default), or compress first and encrypt with 'aes-256-gcm' or 'chacha20-poly1305' under an RSA-wrapped session key\n";
     std::cout << "\n📝 Examples:\n";
-    std::cout << "  " << programName << " --compress $INPUT_FILE $OUTPUT_FILE " << YELLOW << "(must include '.perzip' extension)" << RESET << "\n";
+    std::cout << "  " << programName << " --compress $INPUT_FILE $OUTPUT_FILE " << YELLOW << "(must include '.perzip' extension)" << RESET << GREEN << "\n";
+    std::cout << "  " << programName << " --compress $INPUT_FILE $OUTPUT_FILE --max-code-length 11\n";
+    std::cout << "  " << programName << " --compress $INPUT_FILE $OUTPUT_FILE --rsa-bits 2048\n";
+    std::cout << "  " << programName << " --compress $INPUT_FILE $OUTPUT_FILE --cipher aes-256-gcm --rsa-bits 2048\n";
     std::cout << "  " << programName << " --decompress $INPUT_FILE $OUTPUT_FILE $REGEX_OF_FILES_TO_EXTRACT\n";
     std::cout << "  " << programName << " --show $INPUT_FILE\n";
+    std::cout << "  " << programName << " --benchmark $INPUT_FILE\n";
     std::cout << RESET << std::endl;
 }
 
@@ -76,7 +126,353 @@ void printVersion()
     std::cout << GREEN << "🔐 RSA function version 1.0" << RESET << std::endl;
 }
 
-json compress(const char *inputFile, const std::vector<std::string> &files, int prime1, int prime2)
+std::unique_ptr<EntropyCoder> createCoder(const std::string &name, const CompressionOptions &options)
+{
+    /**
+     * Function to create and configure the entropy coder an archive entry is written with
+     *
+     * @param name: The coder name recorded in the archive ('huffman', 'huffman-o1' or 'tans')
+     * @param options: The Huffman options chosen on the command line (or read from the archive)
+     *
+     * @return: The configured coder
+     */
+    if (name == "tans")
+    {
+        return std::make_unique<Tans>();
+    }
+    if (name == "huffman-o1")
+    {
+        return std::make_unique<ContextHuffman>();
+    }
+    if (name != "huffman")
+    {
+        throw std::invalid_argument("❌ Error: Unknown entropy coder '" + name + "'");
+    }
+    std::unique_ptr<Huffman> huffman = std::make_unique<Huffman>();
+    huffman->setMaxCodeLength(options.maxCodeLength);
+    huffman->setAdaptive(options.adaptiveBlocks);
+    huffman->setInterleaved(options.streams > 1);
+    return huffman;
+}
+
+bool encryptsCodedData(const CompressionOptions &options)
+{
+    /**
+     * Function to tell whether encryption runs after the entropy coder instead of before the stages
+     *
+     * @param options: The compression options
+     *
+     * @return: true for block RSA and the bulk ciphers, false for byte-wise RSA
+     */
+    return options.rsaBits || options.cipher != "rsa";
+}
+
+bool packedCipherBits(const CompressionOptions &options)
+{
+    /**
+     * Function to tell whether the byte-wise ciphertext is bit-packed before the stages
+     *
+     * @param options: The compression options
+     *
+     * @return: true when the ciphertext is stored at ceil(log2 n) bits per value
+     */
+    if (encryptsCodedData(options) || options.wordSymbols || options.packCipher == "off")
+    {
+        return false;
+    }
+    // Packed values straddle byte boundaries, so a repeated string only matches an earlier copy
+    // at the same bit alignment: LZ77 and BWT find far fewer matches than on 4-byte words
+    bool matchStage = options.level == "high" || options.lz77;
+    return options.packCipher == "on" || !matchStage;
+}
+
+std::vector<char> applyTransforms(const std::vector<char> &data, const CompressionOptions &options, std::vector<std::string> &transforms)
+{
+    /**
+     * Function to run the stages chosen on the command line in front of the entropy coder
+     *
+     * @param data: The encrypted data (the plain data when encryption runs after the coder)
+     * @param options: The compression options
+     * @param transforms: Where the names of the applied stages are stored, in order
+     *
+     * @return: The data the entropy coder receives
+     */
+    transforms.clear();
+    std::vector<char> output = data;
+    // Runs of whole 4-byte ciphertext words; plain data and packed ciphertext run by byte
+    unsigned runUnit = encryptsCodedData(options) || packedCipherBits(options) ? 1 : 4;
+    if (options.wordSymbols && !encryptsCodedData(options))
+    {
+        std::vector<char> mapped = WordMap::compress(output);
+        if (!mapped.empty())
+        {
+            transforms.push_back("words");
+            output = std::move(mapped);
+            runUnit = 1;  // Every word is now a one-byte index
+        }
+    }
+    Rle rle(runUnit);
+    if (options.rle == "on" || (options.rle == "auto" && rle.worthwhile(output)))
+    {
+        transforms.push_back("rle");
+        output = rle.compress(output);
+    }
+    if (options.level == "high")
+    {
+        Bwt bwt;
+        bwt.setBlockSize(options.bwtBlock);
+        transforms.push_back("bwt");
+        output = bwt.compress(output);
+    }
+    else if (options.lz77)
+    {
+        Lz77 lz77;
+        lz77.setWindowSize(options.lzWindow);
+        lz77.setSearchDepth(options.lzDepth);
+        transforms.push_back("lz77");
+        output = lz77.compress(output);
+    }
+    return output;
+}
+
+std::vector<char> undoTransforms(std::vector<char> data, const std::vector<std::string> &transforms)
+{
+    /**
+     * Function to undo the stages recorded in an archive entry, last one first
+     *
+     * @param data: The output of the entropy decoder
+     * @param transforms: The names of the stages, in the order they were applied
+     *
+     * @return: The encrypted data (throws std::invalid_argument on unknown stages or corrupted data)
+     */
+    for (auto transform = transforms.rbegin(); transform != transforms.rend(); ++transform)
+    {
+        if (*transform == "lz77")
+        {
+            data = Lz77::uncompress(data);
+        }
+        else if (*transform == "bwt")
+        {
+            data = Bwt::uncompress(data);
+        }
+        else if (*transform == "rle")
+        {
+            data = Rle::uncompress(data);
+        }
+        else if (*transform == "words")
+        {
+            data = WordMap::uncompress(data);
+        }
+        else
+        {
+            throw std::invalid_argument("❌ Error: Unknown transform '" + *transform + "'");
+        }
+    }
+    return data;
+}
+
+bool parseCompressionOptions(int argc, char *argv[], int first, CompressionOptions &options)
+{
+    /**
+     * Function to read the compression options that follow the positional arguments
+     *
+     * @param argc: The number of command-line arguments
+     * @param argv: The command-line arguments array
+     * @param first: The index of the first option
+     * @param options: Where the parsed options are stored
+     *
+     * @return: false if an option is unknown or has an invalid value (the error is printed)
+     */
+    for (int i = first; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "--coder" && i + 1 < argc)
+        {
+            std::string coder = argv[++i];
+            if (coder != "huffman" && coder != "huffman-o1" && coder != "tans")
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --coder must be 'huffman', 'huffman-o1' or 'tans'." << RESET << std::endl;
+                return false;
+            }
+            options.coder = coder;
+        }
+        else if (argument == "--max-code-length" && i + 1 < argc)
+        {
+            try
+            {
+                int value = std::stoi(argv[++i]);
+                if (value < 8 || value > 56)
+                {
+                    throw std::out_of_range("max code length");
+                }
+                options.maxCodeLength = static_cast<unsigned>(value);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --max-code-length must be a number between 8 and 56." << RESET << std::endl;
+                return false;
+            }
+        }
+        else if (argument == "--streams" && i + 1 < argc)
+        {
+            std::string streams = argv[++i];
+            if (streams != "1" && streams != "4")
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --streams must be 1 or 4." << RESET << std::endl;
+                return false;
+            }
+            options.streams = static_cast<unsigned>(std::stoi(streams));
+        }
+        else if (argument == "--block-mode" && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode != "adaptive" && mode != "static")
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --block-mode must be 'adaptive' or 'static'." << RESET << std::endl;
+                return false;
+            }
+            options.adaptiveBlocks = mode == "adaptive";
+        }
+        else if (argument == "--word-symbols" && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode != "on" && mode != "off")
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --word-symbols must be 'on' or 'off'." << RESET << std::endl;
+                return false;
+            }
+            options.wordSymbols = mode == "on";
+        }
+        else if (argument == "--pack-cipher" && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode != "auto" && mode != "on" && mode != "off")
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --pack-cipher must be 'auto', 'on' or 'off'." << RESET << std::endl;
+                return false;
+            }
+            options.packCipher = mode;
+        }
+        else if (argument == "--level" && i + 1 < argc)
+        {
+            std::string level = argv[++i];
+            if (level != "normal" && level != "high")
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --level must be 'normal' or 'high'." << RESET << std::endl;
+                return false;
+            }
+            options.level = level;
+        }
+        else if (argument == "--bwt-block" && i + 1 < argc)
+        {
+            try
+            {
+                long long value = std::stoll(argv[++i]);
+                if (value < static_cast<long long>(Bwt::MIN_BLOCK_SIZE) || value > static_cast<long long>(Bwt::MAX_BLOCK_SIZE))
+                {
+                    throw std::out_of_range("bwt block");
+                }
+                options.bwtBlock = static_cast<size_t>(value);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --bwt-block must be a number between 1024 and 16777216." << RESET << std::endl;
+                return false;
+            }
+        }
+        else if (argument == "--rle" && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode != "auto" && mode != "on" && mode != "off")
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --rle must be 'auto', 'on' or 'off'." << RESET << std::endl;
+                return false;
+            }
+            options.rle = mode;
+        }
+        else if (argument == "--lz77" && i + 1 < argc)
+        {
+            std::string mode = argv[++i];
+            if (mode != "on" && mode != "off")
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --lz77 must be 'on' or 'off'." << RESET << std::endl;
+                return false;
+            }
+            options.lz77 = mode == "on";
+        }
+        else if (argument == "--lz-window" && i + 1 < argc)
+        {
+            try
+            {
+                long long value = std::stoll(argv[++i]);
+                if (value < static_cast<long long>(Lz77::MIN_WINDOW_SIZE) || value > static_cast<long long>(Lz77::MAX_WINDOW_SIZE) ||
+                    (value & (value - 1)) != 0)
+                {
+                    throw std::out_of_range("lz window");
+                }
+                options.lzWindow = static_cast<size_t>(value);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --lz-window must be a power of two between 1024 and 16777216." << RESET << std::endl;
+                return false;
+            }
+        }
+        else if (argument == "--rsa-bits" && i + 1 < argc)
+        {
+            try
+            {
+                int value = std::stoi(argv[++i]);
+                if (value != 0 && !BigRsa::isSupportedSize(static_cast<unsigned>(value)))
+                {
+                    throw std::out_of_range("rsa bits");
+                }
+                options.rsaBits = static_cast<unsigned>(value);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --rsa-bits must be 0, 2048, 3072 or 4096." << RESET << std::endl;
+                return false;
+            }
+        }
+        else if (argument == "--cipher" && i + 1 < argc)
+        {
+            std::string cipher = argv[++i];
+            if (cipher != "rsa" && !BulkCipher::isSupported(cipher))
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --cipher must be 'rsa', 'aes-256-gcm' or 'chacha20-poly1305'." << RESET << std::endl;
+                return false;
+            }
+            options.cipher = cipher;
+        }
+        else if (argument == "--lz-depth" && i + 1 < argc)
+        {
+            try
+            {
+                int value = std::stoi(argv[++i]);
+                if (value < 1 || value > 4096)
+                {
+                    throw std::out_of_range("lz depth");
+                }
+                options.lzDepth = static_cast<unsigned>(value);
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << RED << ERROR_EMOJI << " Error: --lz-depth must be a number between 1 and 4096." << RESET << std::endl;
+                return false;
+            }
+        }
+        else
+        {
+            std::cerr << RED << ERROR_EMOJI << " Error: Unknown compression option '" << argument << "'." << RESET << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+json compress(const char *inputFile, const std::vector<std::string> &files, int prime1, int prime2, const CompressionOptions &options)
 {
     /**
      * Function to compress and encrypt files using RSA and Huffman encoding
@@ -85,6 +481,7 @@ json compress(const char *inputFile, const std::vector<std::string> &files, int
      * @param files: A vector of file paths to be compressed and encrypted
      * @param prime1: The first prime number for RSA key generation
      * @param prime2: The second prime number for RSA key generation
+     * @param options: The entropy coder options chosen on the command line
      *
      * @return: A JSON object containing the public key, private key, and compressed file data
      */
@@ -93,15 +490,45 @@ json compress(const char *inputFile, const std::vector<std::string> &files, int
     Rsa rsa_management(prime1, prime2);
     json jsonData;
 
-    ResultGenerateKeys keys = rsa_management.generateKeys();
-    jsonData["public_key"] = keys.publicKey;
-    jsonData["private_key"] = keys.privateKey;
+    std::string publicKey, privateKey;
+    if (options.rsaBits)
+    {
+        BigRsaKeys keys = BigRsa(options.rsaBits).generateKeys();
+        publicKey = keys.publicKey;
+        privateKey = keys.privateKey;
+        jsonData["rsa_bits"] = options.rsaBits;
+    }
+    else
+    {
+        ResultGenerateKeys keys = rsa_management.generateKeys();
+        publicKey = keys.publicKey;
+        privateKey = keys.privateKey;
+    }
+    unsigned cipherBits = packedCipherBits(options) ? Rsa::cipherBits(publicKey) : 0;
+    if (cipherBits)
+    {
+        jsonData["cipher_bits"] = cipherBits;
+    }
+    jsonData["public_key"] = publicKey;
+    jsonData["private_key"] = privateKey;
     jsonData["files"] = json::array();
 
+    // Hybrid mode: one random session key per archive, stored wrapped with the RSA key
+    std::unique_ptr<BulkCipher> bulkCipher;
+    std::vector<uint8_t> sessionKey;
+    if (options.cipher != "rsa")
+    {
+        bulkCipher = std::make_unique<BulkCipher>(options.cipher);
+        sessionKey = BulkCipher::generateKey();
+        std::vector<uint8_t> wrappedKey = options.rsaBits ? BigRsa::encrypt(sessionKey, publicKey) : rsa_management.encrypt(sessionKey, publicKey);
+        jsonData["bulk_cipher"] = options.cipher;
+        jsonData["session_key"] = Utils::binaryToBase64(wrappedKey);
+    }
+
     for (size_t i = 0; i < files.size(); i++)
     {
         std::cout << CYAN << "  " << FILE_EMOJI << " Processing: " << files[i] << "..." << RESET << std::endl;
-        Huffman huffman;
+        std::unique_ptr<EntropyCoder> coder = createCoder(options.coder, options);
         std::vector<uint8_t> fileData = FileManager::readBinaryFile(files[i]);
         if (fileData.empty())
         {
@@ -109,36 +536,46 @@ json compress(const char *inputFile, const std::vector<std::string> &files, int
             continue;
         }
 
-        std::vector<uint8_t> encryptedData = rsa_management.encrypt(fileData, keys.publicKey);
-        if (encryptedData.empty())
+        // Block RSA and the bulk ciphers encrypt the coded data, byte-wise RSA the input of the stages
+        std::vector<char> encryptedDataChars(fileData.begin(), fileData.end());
+        if (!encryptsCodedData(options))
         {
-            std::cerr << RED << ERROR_EMOJI << " Warning: Failed to encrypt file " << files[i] << RESET << std::endl;
-            continue;
+            std::vector<uint8_t> encryptedData = rsa_management.encrypt(fileData, publicKey, cipherBits);
+            if (encryptedData.empty())
+            {
+                std::cerr << RED << ERROR_EMOJI << " Warning: Failed to encrypt file " << files[i] << RESET << std::endl;
+                continue;
+            }
+            encryptedDataChars.assign(encryptedData.begin(), encryptedData.end());
         }
 
-        std::vector<char> encryptedDataChars(encryptedData.begin(), encryptedData.end());
-        std::unordered_map<char, int> freqMap = Utils::createFreqMap(encryptedDataChars);
-        if (freqMap.empty())
+        std::vector<std::string> transforms;
+        std::vector<char> coderInput = applyTransforms(encryptedDataChars, options, transforms);
+        coder->fitModel(coderInput);
+        Huffman *huffman = dynamic_cast<Huffman *>(coder.get());
+        if (huffman && options.maxCodeLength)
         {
-            std::cerr << RED << ERROR_EMOJI << " Warning: Frequency map is empty for file " << files[i] << RESET << std::endl;
-            continue;
+            std::cout << CYAN << "  " << INFO_EMOJI << "Code lengths capped at " << options.maxCodeLength << " bits, ratio loss: "
+                      << huffman->getRatioLoss() * 100 << "%" << RESET << std::endl;
         }
-        huffman.buildTree(freqMap);
-        std::vector<char> compressedData = huffman.compress(encryptedDataChars);
+        std::vector<uint8_t> compressedData = coder->compress(coderInput);
         if (compressedData.empty())
         {
             std::cerr << RED << ERROR_EMOJI << " Warning: Failed to compress file " << files[i] << RESET << std::endl;
             continue;
         }
-        std::vector<uint8_t> compressedDataUint8(compressedData.begin(), compressedData.end());
-        std::string encodedData = Utils::binaryToBase64(compressedDataUint8); // Fixed: Changed base64ToBinary to binaryToBase64
-
-        std::unordered_map<std::string, char> reverseCodes = huffman.getReverseCodes();
-        if (reverseCodes.empty())
+        // Every entry is its own stream of the session key, so no two chunks share a nonce
+        uint32_t cipherStream = static_cast<uint32_t>(jsonData["files"].size());
+        if (bulkCipher)
         {
-            std::cerr << RED << ERROR_EMOJI << " Warning: Reverse codes are empty for file " << files[i] << RESET << std::endl;
-            continue;
+            compressedData = bulkCipher->encrypt(compressedData, sessionKey, cipherStream);
+        }
+        else if (options.rsaBits)
+        {
+            compressedData = BigRsa::encrypt(compressedData, publicKey);
         }
+        std::string encodedData = Utils::binaryToBase64(compressedData);
+
 
         json fileEntry;
         std::string inputFileRegex, fileName;
@@ -157,14 +594,38 @@ json compress(const char *inputFile, const std::vector<std::string> &files, int
 
         fileEntry["file_name"] = std::regex_replace(fileName, std::regex(inputFileRegex), lastPart);
         fileEntry["file_data"] = encodedData;
-        fileEntry["huffman_table"] = json::array();
-
-        for (const auto &pair : reverseCodes)
+        fileEntry["original_size"] = coderInput.size();
+        if (bulkCipher)
+        {
+            fileEntry["cipher_stream"] = cipherStream;
+        }
+        fileEntry["entropy_coder"] = coder->getName();
+        if (!transforms.empty())
         {
-            json tableEntry;
-            tableEntry["letter"] = pair.second;
-            tableEntry["code"] = pair.first;
-            fileEntry["huffman_table"].push_back(tableEntry);
+            fileEntry["transforms"] = transforms;
+        }
+        fileEntry["code_lengths"] = Utils::binaryToBase64(coder->getTable());
+        bool perBlockEncodings = huffman && options.adaptiveBlocks;
+        if (huffman)
+        {
+            fileEntry["huffman_streams"] = options.streams;
+        }
+        fileEntry["block_bit_offsets"] = json::array();
+        fileEntry["block_output_offsets"] = json::array();
+        if (perBlockEncodings)
+        {
+            fileEntry["block_raw"] = json::array();
+            fileEntry["block_code_lengths"] = json::array();
+        }
+        for (const CodedBlock &block : coder->getBlocks())
+        {
+            fileEntry["block_bit_offsets"].push_back(block.bitOffset);
+            fileEntry["block_output_offsets"].push_back(block.outputOffset);
+            if (perBlockEncodings)
+            {
+                fileEntry["block_raw"].push_back(block.raw);
+                fileEntry["block_code_lengths"].push_back(block.codeLengths.empty() ? "" : Utils::binaryToBase64(block.codeLengths));
+            }
         }
 
         jsonData["files"].push_back(fileEntry);
@@ -193,6 +654,23 @@ void decompress(const char *inputFile, const char *outputFile, std::string regex
     Rsa rsa_management(prime1, prime2);
     ArchiveData archive = FileManager::loadJsonFile(inputFile);
 
+    std::unique_ptr<BulkCipher> bulkCipher;
+    std::vector<uint8_t> sessionKey;
+    if (!archive.bulk_cipher.empty())
+    {
+        try
+        {
+            bulkCipher = std::make_unique<BulkCipher>(archive.bulk_cipher);
+            std::vector<uint8_t> wrappedKey = Utils::base64ToBinary(archive.session_key);
+            sessionKey = archive.rsa_bits ? BigRsa::decrypt(wrappedKey, archive.private_key) : rsa_management.decrypt(wrappedKey, archive.private_key);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << RED << e.what() << RESET << std::endl;
+            return;
+        }
+    }
+
     bool withoutExternalFolder = false;
     if (regexStr.empty())
     {
@@ -215,7 +693,6 @@ void decompress(const char *inputFile, const char *outputFile, std::string regex
     for (const auto &fileEntry : archive.files)
     {
         std::cout << CYAN << "  " << FILE_EMOJI << " Decompressing: " << fileEntry.file_name << "..." << RESET << std::endl;
-        Huffman huffman;
         std::string fileName = fileEntry.file_name;
 
         if (!std::regex_search(fileName, std::regex(regexStr)))
@@ -240,18 +717,62 @@ void decompress(const char *inputFile, const char *outputFile, std::string regex
 
         std::string fileData = fileEntry.file_data;
         std::vector<uint8_t> decodedData = Utils::base64ToBinary(fileData.c_str());
-        std::vector<char> decodedDataChars(decodedData.begin(), decodedData.end());
 
-        std::unordered_map<std::string, char> reverseCodes = fileEntry.huffman_table;
-        std::vector<char> decompressedData = huffman.uncompress(decodedDataChars, &reverseCodes);
-        if (decompressedData.empty())
+        std::vector<uint8_t> coderTable = Utils::base64ToBinary(fileEntry.code_lengths);
+        std::vector<CodedBlock> blocks;
+        for (size_t block = 0; block < fileEntry.block_bit_offsets.size(); block++)
+        {
+            CodedBlock entry{fileEntry.block_bit_offsets[block], fileEntry.block_output_offsets[block], false, {}};
+            if (!fileEntry.block_raw.empty())
+            {
+                entry.raw = fileEntry.block_raw[block];
+                if (!fileEntry.block_code_lengths[block].empty())
+                {
+                    entry.codeLengths = Utils::base64ToBinary(fileEntry.block_code_lengths[block]);
+                }
+            }
+            blocks.push_back(entry);
+        }
+        CompressionOptions entryOptions;
+        entryOptions.streams = fileEntry.huffman_streams;
+        std::vector<char> decompressedData;
+        try
+        {
+            if (bulkCipher)
+            {
+                decodedData = bulkCipher->decrypt(decodedData, sessionKey, fileEntry.cipher_stream);
+            }
+            else if (archive.rsa_bits)
+            {
+                decodedData = BigRsa::decrypt(decodedData, archive.private_key);
+            }
+            std::unique_ptr<EntropyCoder> coder = createCoder(fileEntry.entropy_coder, entryOptions);
+            decompressedData = coder->uncompress(decodedData, fileEntry.original_size, &coderTable, &blocks);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << RED << e.what() << " (" << fileName << ")" << RESET << std::endl;
+            continue;
+        }
+        if (decompressedData.size() != fileEntry.original_size)
         {
             std::cerr << RED << ERROR_EMOJI << " Warning: Failed to decompress file " << fileName << RESET << std::endl;
             continue;
         }
-        std::vector<uint8_t> decompressedDataUint8(decompressedData.begin(), decompressedData.end());
-
-        std::vector<uint8_t> decryptedData = rsa_management.decrypt(decompressedDataUint8, archive.private_key);
+        try
+        {
+            decompressedData = undoTransforms(decompressedData, fileEntry.transforms);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << RED << e.what() << " (" << fileName << ")" << RESET << std::endl;
+            continue;
+        }
+        std::vector<uint8_t> decryptedData(decompressedData.begin(), decompressedData.end());
+        if (!archive.rsa_bits && !bulkCipher)
+        {
+            decryptedData = rsa_management.decrypt(decryptedData, archive.private_key, archive.cipher_bits);
+        }
         if (decryptedData.empty())
         {
             std::cerr << RED << ERROR_EMOJI << " Warning: Failed to decrypt file " << fileName << RESET << std::endl;
@@ -277,6 +798,105 @@ void decompress(const char *inputFile, const char *outputFile, std::string regex
     std::cout << GREEN << CHECK_EMOJI << " Decompression completed!" << RESET << std::endl;
 }
 
+void benchmark(const std::vector<std::string> &files, int prime1, int prime2, const CompressionOptions &options)
+{
+    /**
+     * Function to run every entropy coder over the same encrypted data and report the
+     * compressed size and the compress/uncompress times of each one
+     *
+     * @param files: A vector of file paths to be encrypted and compressed
+     * @param prime1: The first prime number for RSA key generation
+     * @param prime2: The second prime number for RSA key generation
+     * @param options: The entropy coder options chosen on the command line
+     *
+     * @return: None
+     */
+    std::cout << BLUE << "\n"
+              << FILE_EMOJI << " Starting benchmark..." << RESET << std::endl;
+    Rsa rsa_management(prime1, prime2);
+    ResultGenerateKeys keys = rsa_management.generateKeys();
+
+    std::vector<std::vector<char>> inputs;
+    size_t inputBytes = 0;
+    for (const std::string &file : files)
+    {
+        std::vector<uint8_t> fileData = FileManager::readBinaryFile(file);
+        if (fileData.empty())
+        {
+            continue;
+        }
+        // Block RSA and the bulk ciphers run after the coders, so they are compared on the plain data
+        std::vector<uint8_t> encryptedData = encryptsCodedData(options) ? fileData
+                                                             : rsa_management.encrypt(fileData, keys.publicKey, packedCipherBits(options) ? Rsa::cipherBits(keys.publicKey) : 0);
+        inputs.emplace_back(encryptedData.begin(), encryptedData.end());
+        inputBytes += encryptedData.size();
+    }
+    if (inputs.empty())
+    {
+        std::cerr << RED << ERROR_EMOJI << " Error: No data to benchmark." << RESET << std::endl;
+        return;
+    }
+
+    // The transform stages are shared by every coder, so they run once and their time is added to each
+    std::vector<std::vector<char>> coderInputs;
+    std::vector<std::vector<std::string>> transforms(inputs.size());
+    auto transformStart = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        coderInputs.push_back(applyTransforms(inputs[i], options, transforms[i]));
+    }
+    long long transformMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - transformStart).count();
+
+    struct Result
+    {
+        std::string coder;
+        size_t compressedBytes = 0;  // Encoded streams plus the tables stored in the archive
+        long long compressMs = 0;
+        long long uncompressMs = 0;
+        bool roundTrip = true;
+    };
+    std::vector<Result> results;
+    for (const std::string &name : {std::string("huffman"), std::string("huffman-o1"), std::string("tans")})
+    {
+        Result result;
+        result.coder = name;
+        result.compressMs = transformMs;
+        for (size_t i = 0; i < inputs.size(); i++)
+        {
+            const std::vector<char> &input = coderInputs[i];
+            std::unique_ptr<EntropyCoder> coder = createCoder(name, options);
+            auto start = std::chrono::high_resolution_clock::now();
+            coder->fitModel(input);
+            std::vector<uint8_t> compressedData = coder->compress(input);
+            auto middle = std::chrono::high_resolution_clock::now();
+
+            std::vector<uint8_t> table = coder->getTable();
+            std::vector<CodedBlock> blocks = coder->getBlocks();
+            std::unique_ptr<EntropyCoder> decoder = createCoder(name, options);
+            std::vector<char> output = undoTransforms(decoder->uncompress(compressedData, input.size(), &table, &blocks), transforms[i]);
+            auto end = std::chrono::high_resolution_clock::now();
+
+            result.compressedBytes += compressedData.size() + table.size();
+            for (const CodedBlock &block : blocks)
+            {
+                result.compressedBytes += block.codeLengths.size();
+            }
+            result.compressMs += std::chrono::duration_cast<std::chrono::milliseconds>(middle - start).count();
+            result.uncompressMs += std::chrono::duration_cast<std::chrono::milliseconds>(end - middle).count();
+            result.roundTrip = result.roundTrip && output == inputs[i];
+        }
+        results.push_back(result);
+    }
+
+    std::cout << CYAN << "\n⏱️  Benchmark over " << inputBytes << " encrypted bytes (" << inputs.size() << " files):" << RESET << "\n";
+    for (const Result &result : results)
+    {
+        std::cout << (result.roundTrip ? GREEN : RED) << "  " << result.coder << ": " << result.compressedBytes << " bytes ("
+                  << 100.0 * result.compressedBytes / inputBytes << "%), compress " << result.compressMs << " ms, uncompress "
+                  << result.uncompressMs << " ms" << (result.roundTrip ? "" : ", ROUND TRIP FAILED") << RESET << std::endl;
+    }
+}
+
 int main(int argc, char *argv[])
 {
     /**
@@ -298,22 +918,40 @@ int main(int argc, char *argv[])
     const char *prime1_env = std::getenv("PRIME1");
     const char *prime2_env = std::getenv("PRIME2");
 
-    if (!prime1_env || !prime2_env)
+    if (!prime1_env != !prime2_env)
     {
-        std::cerr << RED << ERROR_EMOJI << " Error: Environment variables PRIME1 and PRIME2 must be set." << RESET << std::endl;
+        std::cerr << RED << ERROR_EMOJI << " Error: Set both PRIME1 and PRIME2, or neither to generate random primes." << RESET << std::endl;
         return 1;
     }
 
     int PRIME1, PRIME2;
-    try
+    if (prime1_env)
     {
-        PRIME1 = std::stoi(prime1_env);
-        PRIME2 = std::stoi(prime2_env);
+        try
+        {
+            PRIME1 = std::stoi(prime1_env);
+            PRIME2 = std::stoi(prime2_env);
+            // The byte-wise key needs 256 <= n < 2^31, with n = PRIME1 * PRIME2
+            long long n = static_cast<long long>(PRIME1) * PRIME2;
+            if (!Utils::isPrime(PRIME1) || !Utils::isPrime(PRIME2) || PRIME1 % 2 == 0 || PRIME2 % 2 == 0 || PRIME1 == PRIME2 || n < 256 || n > INT32_MAX)
+            {
+                throw std::out_of_range("primes");
+            }
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << RED << ERROR_EMOJI << " Error: PRIME1 and PRIME2 must be two different odd primes whose product is between 256 and 2^31 - 1." << RESET << std::endl;
+            return 1;
+        }
     }
-    catch (const std::exception &e)
+    else
     {
-        std::cerr << RED << ERROR_EMOJI << " Error: Invalid values for PRIME1 or PRIME2 environment variables." << RESET << std::endl;
-        return 1;
+        // Two random primes keep n below 2^30, within the int arithmetic of the byte-wise key
+        do
+        {
+            PRIME1 = Utils::randomPrime(PRIME_BITS);
+            PRIME2 = Utils::randomPrime(PRIME_BITS);
+        } while (PRIME1 == PRIME2);
     }
 
     std::string option = argv[1];
@@ -358,7 +996,13 @@ int main(int argc, char *argv[])
             return 1;
         }
 
-        json jsonData = compress(argv[2], allFiles, PRIME1, PRIME2);
+        CompressionOptions options;
+        if (!parseCompressionOptions(argc, argv, 4, options))
+        {
+            return 1;
+        }
+
+        json jsonData = compress(argv[2], allFiles, PRIME1, PRIME2, options);
         if (FileManager::saveJsonFile(argv[3], jsonData))
         {
             std::cout << GREEN << CHECK_EMOJI << " JSON file created successfully: " << argv[3] << RESET << std::endl;
@@ -388,6 +1032,27 @@ int main(int argc, char *argv[])
         std::string regexStr = argc > 4 ? argv[4] : "";
         decompress(inputFile.c_str(), outputFile.c_str(), regexStr, PRIME1, PRIME2);
     }
+    else if (option == "--benchmark" || option == "-b")
+    {
+        if (argc < 3)
+        {
+            std::cerr << RED << ERROR_EMOJI << " Error: Missing input file for --benchmark option." << RESET << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!std::filesystem::exists(argv[2]))
+        {
+            std::cerr << RED << ERROR_EMOJI << " Error: Input file or directory '" << argv[2] << "' does not exist." << RESET << std::endl;
+            return 1;
+        }
+
+        CompressionOptions options;
+        if (!parseCompressionOptions(argc, argv, 3, options))
+        {
+            return 1;
+        }
+        benchmark(FileManager::getAllFilestoProcess(argv[2]), PRIME1, PRIME2, options);
+    }
     else if (option == "--show" || option == "-s")
     {
         if (argc < 3)
@@ -427,7 +1092,7 @@ int main(int argc, char *argv[])
         return 1;
     }
     auto end = std::chrono::high_resolution_clock::now();
-    printf("\033[1;32m🟢 [Timing] Total execution time: %lld ms\033[0m\n", std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    printf("\033[1;32m🟢 [Timing] Total execution time: %lld ms\033[0m\n", static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count()));
 
     return 0;
 }
\ No newline at end of file
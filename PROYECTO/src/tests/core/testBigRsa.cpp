@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "../../core/BigRsa.h"
+#include "../../helpers/Utils.h"
+
+// 1024-bit keys keep the key generation of the tests fast; the block logic is the same at any size
+static const BigRsaKeys &testKeys() {
+    static const BigRsaKeys keys = BigRsa(1024).generateKeys();
+    return keys;
+}
+
+TEST(BigRsaTest, BlocksRoundTripWithSmallExpansion) {
+    const size_t blockBytes = 1024 / 8;
+    const size_t payloadBytes = blockBytes - BigRsa::PADDING_BYTES;
+    for (size_t size : {size_t(0), size_t(1), payloadBytes - 1, payloadBytes, payloadBytes + 1, size_t(100000)}) {
+        std::vector<uint8_t> message(size);
+        for (size_t i = 0; i < size; i++) {
+            message[i] = static_cast<uint8_t>(i * 31 + i / 7);
+        }
+        std::vector<uint8_t> encrypted = BigRsa::encrypt(message, testKeys().publicKey);
+        EXPECT_EQ(encrypted.size(), (size + payloadBytes - 1) / payloadBytes * blockBytes);
+        EXPECT_EQ(BigRsa::decrypt(encrypted, testKeys().privateKey), message);
+    }
+
+    // Random padding makes every encryption of the same block different
+    std::vector<uint8_t> zeros(50, 0);
+    EXPECT_NE(BigRsa::encrypt(zeros, testKeys().publicKey), BigRsa::encrypt(zeros, testKeys().publicKey));
+}
+
+TEST(BigRsaTest, RejectsWrongKeysAndCorruptedBlocks) {
+    std::vector<uint8_t> message(1000, 'a');
+    std::vector<uint8_t> encrypted = BigRsa::encrypt(message, testKeys().publicKey);
+
+    std::vector<uint8_t> truncated(encrypted.begin(), encrypted.end() - 1);
+    EXPECT_THROW(BigRsa::decrypt(truncated, testKeys().privateKey), std::invalid_argument);
+    std::vector<uint8_t> corrupted = encrypted;
+    corrupted[corrupted.size() / 2] ^= 0x40;
+    EXPECT_THROW(BigRsa::decrypt(corrupted, testKeys().privateKey), std::invalid_argument);
+
+    BigRsaKeys otherKeys = BigRsa(1024).generateKeys();
+    EXPECT_THROW(BigRsa::decrypt(encrypted, otherKeys.privateKey), std::invalid_argument);
+    EXPECT_THROW(BigRsa::encrypt(message, ""), std::invalid_argument);
+    EXPECT_THROW(BigRsa(1000), std::invalid_argument);
+    EXPECT_TRUE(BigRsa::isSupportedSize(2048));
+    EXPECT_FALSE(BigRsa::isSupportedSize(1024));
+}
+
+TEST(BigRsaTest, CrtDecryptionMatchesPlainExponentiation) {
+    // The private key is {d, n, p, q, dP, dQ, qInv}; keeping only its first two numbers disables CRT
+    std::vector<uint8_t> serialized = Utils::base64ToBinary(testKeys().privateKey);
+    size_t numbers = 0, position = 0, plainKeyBytes = 0;
+    while (position < serialized.size()) {
+        uint32_t length = (serialized[position] << 24) | (serialized[position + 1] << 16) | (serialized[position + 2] << 8) | serialized[position + 3];
+        position += 4 + length;
+        if (++numbers == 2) {
+            plainKeyBytes = position;
+        }
+    }
+    ASSERT_EQ(numbers, 7u);
+    std::string plainKey = Utils::binaryToBase64(std::vector<uint8_t>(serialized.begin(), serialized.begin() + plainKeyBytes));
+
+    std::vector<uint8_t> message(20000);
+    for (size_t i = 0; i < message.size(); i++) {
+        message[i] = static_cast<uint8_t>(i ^ (i >> 5));
+    }
+    std::vector<uint8_t> encrypted = BigRsa::encrypt(message, testKeys().publicKey);
+    EXPECT_EQ(BigRsa::decrypt(encrypted, plainKey), message);
+    EXPECT_EQ(BigRsa::decrypt(encrypted, testKeys().privateKey), message);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include "../../core/BulkCipher.h"
+
+static std::vector<uint8_t> testData(size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<uint8_t>(i * 29 + i / 4099);
+    }
+    return data;
+}
+
+TEST(BulkCipherTest, ChunkedRoundTrip) {
+    const size_t chunk = BulkCipher::CHUNK_SIZE;
+    for (const std::string name : {"aes-256-gcm", "chacha20-poly1305"}) {
+        BulkCipher cipher(name);
+        std::vector<uint8_t> key = BulkCipher::generateKey();
+        for (size_t size : {size_t(0), size_t(1), chunk - 1, chunk, chunk + 1, 3 * chunk + 12345}) {
+            std::vector<uint8_t> data = testData(size);
+            std::vector<uint8_t> encrypted = cipher.encrypt(data, key, 7);
+            size_t chunks = std::max<size_t>(1, (size + chunk - 1) / chunk);
+            EXPECT_EQ(encrypted.size(), size + chunks * BulkCipher::TAG_BYTES);
+            EXPECT_EQ(cipher.decrypt(encrypted, key, 7), data) << name << " " << size;
+        }
+    }
+}
+
+TEST(BulkCipherTest, RejectsTamperingAndWrongKeysOrStreams) {
+    BulkCipher cipher("aes-256-gcm");
+    std::vector<uint8_t> key = BulkCipher::generateKey();
+    std::vector<uint8_t> data = testData(2 * BulkCipher::CHUNK_SIZE + 100);
+    std::vector<uint8_t> encrypted = cipher.encrypt(data, key, 1);
+
+    std::vector<uint8_t> flipped = encrypted;
+    flipped[BulkCipher::CHUNK_SIZE + 5] ^= 1;
+    EXPECT_THROW(cipher.decrypt(flipped, key, 1), std::invalid_argument);
+    EXPECT_THROW(cipher.decrypt(encrypted, key, 2), std::invalid_argument);
+    EXPECT_THROW(cipher.decrypt(encrypted, BulkCipher::generateKey(), 1), std::invalid_argument);
+    EXPECT_THROW(BulkCipher("chacha20-poly1305").decrypt(encrypted, key, 1), std::invalid_argument);
+
+    // Dropping the last chunk leaves a stream whose new last chunk was not sealed as last
+    std::vector<uint8_t> truncated(encrypted.begin(), encrypted.begin() + 2 * (BulkCipher::CHUNK_SIZE + BulkCipher::TAG_BYTES));
+    EXPECT_THROW(cipher.decrypt(truncated, key, 1), std::invalid_argument);
+    EXPECT_THROW(cipher.decrypt(std::vector<uint8_t>(), key, 1), std::invalid_argument);
+    EXPECT_THROW(cipher.encrypt(data, std::vector<uint8_t>(16), 1), std::invalid_argument);
+    EXPECT_THROW(BulkCipher("des"), std::invalid_argument);
+}
+
+TEST(BulkCipherTest, Throughput) {
+    // Informative only: encryption and decryption speed of both ciphers over 64 MiB
+    std::vector<uint8_t> data = testData(64 << 20);
+    std::vector<uint8_t> key = BulkCipher::generateKey();
+    for (const std::string name : {"aes-256-gcm", "chacha20-poly1305"}) {
+        BulkCipher cipher(name);
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<uint8_t> encrypted = cipher.encrypt(data, key, 0);
+        auto middle = std::chrono::high_resolution_clock::now();
+        std::vector<uint8_t> decrypted = cipher.decrypt(encrypted, key, 0);
+        auto end = std::chrono::high_resolution_clock::now();
+        double encryptSeconds = std::chrono::duration<double>(middle - start).count();
+        double decryptSeconds = std::chrono::duration<double>(end - middle).count();
+        std::cout << name << ": encrypt " << data.size() / encryptSeconds / 1e9 << " GB/s, decrypt "
+                  << data.size() / decryptSeconds / 1e9 << " GB/s" << std::endl;
+        EXPECT_EQ(decrypted, data);
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "../../core/Bwt.h"
+#include <stdexcept>
+
+TEST(BwtTest, TextShrinksAndRoundTrips) {
+    std::vector<char> message;
+    const char *words[] = {"compress ", "encrypt ", "huffman ", "block ", "the ", "a ", "rsa\n"};
+    uint32_t state = 12345;
+    for (int i = 0; i < 200000; i++) {
+        state = state * 1103515245 + 12345;
+        const char *word = words[(state >> 16) % 7];
+        message.insert(message.end(), word, word + strlen(word));
+    }
+
+    Bwt bwt;
+    bwt.setBlockSize(1 << 18);
+    std::vector<char> compressedMessage = bwt.compress(message);
+    size_t smallValues = 0;
+    for (char byte : compressedMessage) {
+        smallValues += static_cast<uint8_t>(byte) <= 3;
+    }
+    // Zero-run digits and recently seen bytes dominate, the entropy coder gets very skewed data
+    EXPECT_GT(smallValues * 2, compressedMessage.size());
+    EXPECT_LT(compressedMessage.size() * 3, message.size());
+    EXPECT_EQ(Bwt::uncompress(compressedMessage), message);
+}
+
+TEST(BwtTest, RepetitiveAndBinaryInputs) {
+    // Runs, periodic data and every byte value stress the suffix sorting and the escapes
+    std::vector<char> run(100000, 'x');
+    std::vector<char> periodic;
+    for (int i = 0; i < 100000; i++) {
+        periodic.push_back("abcab"[i % 5]);
+    }
+    std::vector<char> binary;
+    uint32_t state = 99;
+    for (int i = 0; i < 100000; i++) {
+        state = state * 1103515245 + 12345;
+        binary.push_back(static_cast<char>(state >> 16));
+    }
+
+    Bwt bwt;
+    bwt.setBlockSize(1 << 15);
+    for (const std::vector<char> &message : {run, periodic, binary, std::vector<char>(), std::vector<char>{'q'},
+                                             std::vector<char>{'b', 'a', 'n', 'a', 'n', 'a'}}) {
+        EXPECT_EQ(Bwt::uncompress(bwt.compress(message)), message);
+    }
+    EXPECT_LT(bwt.compress(run).size(), 200u);
+}
+
+TEST(BwtTest, InvalidStreamsAndSettings) {
+    Bwt bwt;
+    EXPECT_THROW(bwt.setBlockSize(100), std::invalid_argument);
+    EXPECT_THROW(bwt.setBlockSize(size_t(1) << 25), std::invalid_argument);
+
+    std::vector<char> message;
+    for (int i = 0; i < 5000; i++) {
+        message.push_back(static_cast<char>('a' + i % 17));
+    }
+    std::vector<char> compressedMessage = bwt.compress(message);
+    std::vector<char> badPrimary = compressedMessage;
+    badPrimary[12] = static_cast<char>(0xFF);
+    badPrimary[13] = static_cast<char>(0xFF);
+    EXPECT_THROW(Bwt::uncompress(badPrimary), std::invalid_argument);
+    std::vector<char> truncated(compressedMessage.begin(), compressedMessage.end() - 1);
+    EXPECT_THROW(Bwt::uncompress(truncated), std::invalid_argument);
+    EXPECT_THROW(Bwt::uncompress(std::vector<char>(4, 0)), std::invalid_argument);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
 #include "../../core/Huffman.h"
+#include "../../core/ContextHuffman.h"
+#include "../../core/HuffmanStream.h"
 #include "../../helpers/FileManager.h"
+#include <algorithm>
+#include <sstream>
+#include <omp.h>
 
 #define TEMPLATE_PATH "src/tests/messages/templateHuffman.txt"
 
@@ -13,28 +18,459 @@ void printMessage(const std::vector<char>& compressedMessage) {
 
 TEST(HuffmanTest, CompressAndUncompress) {
     Huffman huffman;
-    std::unordered_map<char, int> freqMap = {
-        {'a', 3},
-        {'b', 4},
-        {'c', 2},
-        {'d', 1},
-    };
+    FrequencyTable freqMap{};
+    freqMap['a'] = 3;
+    freqMap['b'] = 4;
+    freqMap['c'] = 2;
+    freqMap['d'] = 1;
     huffman.buildTree(freqMap);
 
-    std::vector<char> message = FileManager::readTextFile(TEMPLATE_PATH);
+    std::vector<uint8_t> file = FileManager::readBinaryFile(TEMPLATE_PATH);
+    std::vector<char> message(file.begin(), file.end());
 
-    std::vector<char> compressedMessage = huffman.compress(message);
-    std::vector<char> uncompressedMessage = huffman.uncompress(compressedMessage);
+    std::vector<uint8_t> compressedMessage = huffman.compress(message);
+    std::vector<char> uncompressedMessage = huffman.uncompress(compressedMessage, message.size());
 
     printMessage(message);
-    printMessage(compressedMessage);
     printMessage(uncompressedMessage);
 
+    // "abbacabbcd" takes 19 bits with this table, so it packs into 3 bytes
+    EXPECT_EQ(compressedMessage.size(), 3);
     EXPECT_EQ(message, uncompressedMessage);
 }
 
+TEST(HuffmanTest, CompressAndUncompressWithCodeLengthsOnly) {
+    std::vector<char> message;
+    for (int i = 0; i < 100000; i++) {
+        message.push_back(static_cast<char>((i * i + i / 7) % 251));
+    }
+
+    Huffman encoder;
+    encoder.buildTree(Histogram::count(message));
+    std::vector<uint8_t> compressedMessage = encoder.compress(message);
+    std::vector<uint8_t> codeLengths = encoder.getCodeLengths();
+
+    Huffman decoder;
+    std::vector<char> uncompressedMessage = decoder.uncompress(compressedMessage, message.size(), &codeLengths);
+
+    EXPECT_LT(compressedMessage.size(), message.size());
+    EXPECT_EQ(message, uncompressedMessage);
+}
+
+TEST(HuffmanTest, InvalidCodeLengths) {
+    Huffman huffman;
+    std::vector<uint8_t> codeLengths(256, 0);
+    codeLengths['a'] = 1;
+    codeLengths['b'] = 1;
+    codeLengths['c'] = 1;
+
+    EXPECT_THROW(huffman.setCodeLengths(codeLengths), std::invalid_argument);
+    EXPECT_THROW(huffman.setCodeLengths(std::vector<uint8_t>(10, 1)), std::invalid_argument);
+}
+
+TEST(HuffmanTest, SingleSymbol) {
+    std::vector<char> message(1000, 'z');
+
+    Huffman huffman;
+    huffman.buildTree(Histogram::count(message));
+    std::vector<uint8_t> compressedMessage = huffman.compress(message);
+
+    EXPECT_EQ(compressedMessage.size(), 125);
+    EXPECT_EQ(huffman.uncompress(compressedMessage, message.size()), message);
+}
+
+TEST(HuffmanTest, LongCodesUseSecondLevelAndFallbackTables) {
+    // Fibonacci frequencies give a maximally skewed tree, with codes up to 29 bits
+    FrequencyTable freqMap{};
+    std::vector<char> message;
+    int previous = 1, current = 1;
+    for (int symbol = 0; symbol < 30; symbol++) {
+        freqMap[symbol] = current;
+        message.insert(message.end(), current, static_cast<char>(symbol));
+        int next = previous + current;
+        previous = current;
+        current = next;
+    }
+    std::reverse(message.begin(), message.end());
+
+    Huffman huffman;
+    huffman.buildTree(freqMap);
+    std::vector<uint8_t> compressedMessage = huffman.compress(message);
+
+    EXPECT_EQ(huffman.uncompress(compressedMessage, message.size()), message);
+}
+
+TEST(HuffmanTest, LengthLimitedCodes) {
+    FrequencyTable freqMap{};
+    std::vector<char> message;
+    int previous = 1, current = 1;
+    for (int symbol = 0; symbol < 30; symbol++) {
+        freqMap[symbol] = current;
+        message.insert(message.end(), current, static_cast<char>(symbol));
+        int next = previous + current;
+        previous = current;
+        current = next;
+    }
+
+    Huffman unlimited;
+    unlimited.buildTree(freqMap);
+    std::vector<uint8_t> unlimitedMessage = unlimited.compress(message);
+
+    Huffman huffman;
+    huffman.setMaxCodeLength(11);
+    huffman.buildTree(freqMap);
+    std::vector<uint8_t> codeLengths = huffman.getCodeLengths();
+    EXPECT_LE(*std::max_element(codeLengths.begin(), codeLengths.end()), 11);
+
+    std::vector<uint8_t> compressedMessage = huffman.compress(message);
+    EXPECT_EQ(huffman.uncompress(compressedMessage, message.size()), message);
+    EXPECT_GT(huffman.getRatioLoss(), 0.0);
+    EXPECT_GE(compressedMessage.size(), unlimitedMessage.size());
+    EXPECT_NEAR(static_cast<double>(compressedMessage.size()) / unlimitedMessage.size() - 1.0, huffman.getRatioLoss(), 0.001);
+}
+
+TEST(HuffmanTest, LengthLimitIsOptimal) {
+    // With a 2-bit cap the only prefix code for four symbols is the flat one
+    FrequencyTable freqMap{};
+    freqMap['a'] = 1;
+    freqMap['b'] = 1;
+    freqMap['c'] = 2;
+    freqMap['d'] = 4;
+    Huffman huffman;
+    huffman.setMaxCodeLength(2);
+    huffman.buildTree(freqMap);
+    std::vector<uint8_t> codeLengths = huffman.getCodeLengths();
+    EXPECT_EQ(codeLengths['a'], 2);
+    EXPECT_EQ(codeLengths['b'], 2);
+    EXPECT_EQ(codeLengths['c'], 2);
+    EXPECT_EQ(codeLengths['d'], 2);
+
+    // With a 3-bit cap the unlimited tree already fits and nothing is lost
+    Huffman fits;
+    fits.setMaxCodeLength(3);
+    fits.buildTree(freqMap);
+    EXPECT_EQ(fits.getCodeLengths()['a'], 3);
+    EXPECT_EQ(fits.getRatioLoss(), 0.0);
+
+    Huffman tooShort;
+    tooShort.setMaxCodeLength(1);
+    EXPECT_THROW(tooShort.buildTree(freqMap), std::invalid_argument);
+}
+
+TEST(HuffmanTest, EveryCodeLengthBoundRoundTrips) {
+    // Fibonacci frequencies need codes up to 29 bits; each cap lands on a different decoder
+    FrequencyTable freqMap{};
+    std::vector<char> message;
+    int previous = 1, current = 1;
+    for (int symbol = 0; symbol < 30; symbol++) {
+        freqMap[symbol] = current;
+        message.insert(message.end(), current, static_cast<char>(symbol));
+        int next = previous + current;
+        previous = current;
+        current = next;
+    }
+    std::reverse(message.begin(), message.begin() + message.size() / 2);
+
+    for (unsigned maxLength : {5u, 8u, 10u, 11u, 12u, 14u, 15u, 16u, 0u}) {
+        for (bool interleaved : {false, true}) {
+            Huffman encoder;
+            encoder.setMaxCodeLength(maxLength);
+            encoder.setInterleaved(interleaved);
+            encoder.setBlockSize(10007);
+            encoder.buildTree(freqMap);
+            std::vector<uint8_t> compressedMessage = encoder.compress(message);
+            std::vector<CodedBlock> blocks = encoder.getBlocks();
+            std::vector<uint8_t> codeLengths = encoder.getCodeLengths();
+
+            Huffman decoder;
+            decoder.setInterleaved(interleaved);
+            EXPECT_EQ(decoder.uncompress(compressedMessage, message.size(), &codeLengths, &blocks), message)
+                << maxLength << (interleaved ? " interleaved" : "");
+        }
+    }
+
+    // An incomplete code is left to the generic decoder, which reports the invalid bits
+    std::vector<uint8_t> codeLengths(256, 0);
+    codeLengths['a'] = 1;
+    Huffman decoder;
+    EXPECT_TRUE(decoder.uncompress(std::vector<uint8_t>(64, 0xFF), 100, &codeLengths).empty());
+}
+
+TEST(HuffmanTest, IndependentBlocks) {
+    std::vector<char> message;
+    for (int i = 0; i < 200000; i++) {
+        message.push_back(static_cast<char>((i * 7 + i / 13) % 97));
+    }
+
+    Huffman encoder;
+    encoder.setBlockSize(4096);
+    encoder.buildTree(Histogram::count(message));
+    std::vector<uint8_t> compressedMessage = encoder.compress(message);
+    std::vector<CodedBlock> blocks = encoder.getBlocks();
+    std::vector<uint8_t> codeLengths = encoder.getCodeLengths();
+
+    ASSERT_EQ(blocks.size(), (message.size() + 4095) / 4096);
+    EXPECT_EQ(blocks[0].bitOffset, 0);
+    EXPECT_EQ(blocks[1].outputOffset, 4096);
+
+    Huffman decoder;
+    EXPECT_EQ(decoder.uncompress(compressedMessage, message.size(), &codeLengths, &blocks), message);
+
+    // A block decodes on its own from its recorded bit offset
+    std::vector<CodedBlock> lastBlock = {CodedBlock{blocks.back().bitOffset, 0, false, {}}};
+    size_t lastSize = message.size() - blocks.back().outputOffset;
+    std::vector<char> tail(message.end() - lastSize, message.end());
+    EXPECT_EQ(decoder.uncompress(compressedMessage, lastSize, &codeLengths, &lastBlock), tail);
+}
+
+TEST(HuffmanTest, BlocksSharingBytesAreWrittenConcurrently) {
+    // Tiny blocks make almost every block start and end in the middle of a byte
+    std::vector<char> message;
+    for (int i = 0; i < 50000; i++) {
+        message.push_back(static_cast<char>((i * i) % 13));
+    }
+
+    Huffman huffman;
+    huffman.setBlockSize(7);
+    huffman.buildTree(Histogram::count(message));
+    std::vector<uint8_t> compressedMessage = huffman.compress(message);
+
+    Huffman serial;
+    serial.setBlockSize(message.size());
+    serial.buildTree(Histogram::count(message));
+
+    EXPECT_EQ(compressedMessage, serial.compress(message));
+    EXPECT_EQ(huffman.uncompress(compressedMessage, message.size()), message);
+}
+
+TEST(HuffmanTest, AdaptiveBlocksPickTheirOwnEncoding) {
+    // Block 0 follows the file table, block 1 only uses a few other bytes, block 2 is noise
+    std::vector<char> message;
+    for (int i = 0; i < 8192; i++) {
+        message.push_back(static_cast<char>('a' + (i * 7 + i / 13) % 20));
+    }
+    for (int i = 0; i < 8192; i++) {
+        message.push_back(static_cast<char>('0' + (i * i) % 4));
+    }
+    uint32_t state = 12345;
+    for (int i = 0; i < 8192; i++) {
+        state = state * 1103515245 + 12345;
+        message.push_back(static_cast<char>(state >> 24));
+    }
+
+    FrequencyTable frequencies = Histogram::count(std::vector<char>(message.begin(), message.begin() + 8192));
+    Huffman encoder;
+    encoder.setBlockSize(8192);
+    encoder.setAdaptive(true);
+    encoder.buildTree(frequencies);
+    std::vector<uint8_t> compressedMessage = encoder.compress(message);
+    std::vector<CodedBlock> blocks = encoder.getBlocks();
+    std::vector<uint8_t> codeLengths = encoder.getCodeLengths();
+
+    ASSERT_EQ(blocks.size(), 3u);
+    EXPECT_FALSE(blocks[0].raw);
+    EXPECT_TRUE(blocks[0].codeLengths.empty());
+    EXPECT_FALSE(blocks[1].raw);
+    EXPECT_EQ(blocks[1].codeLengths.size(), 256u);
+    EXPECT_TRUE(blocks[2].raw);
+    EXPECT_EQ(blocks[2].bitOffset % 8, 0u);
+    EXPECT_EQ(compressedMessage.size(), blocks[2].bitOffset / 8 + 8192);
+
+    Huffman decoder;
+    EXPECT_EQ(decoder.uncompress(compressedMessage, message.size(), &codeLengths, &blocks), message);
+
+    // A stored block that runs past the end of the stream is rejected
+    std::vector<uint8_t> truncated(compressedMessage.begin(), compressedMessage.end() - 1);
+    EXPECT_THROW(decoder.uncompress(truncated, message.size(), &codeLengths, &blocks), std::invalid_argument);
+}
+
+TEST(HuffmanTest, InterleavedSubStreams) {
+    std::vector<char> message;
+    for (int i = 0; i < 100003; i++) {
+        message.push_back(static_cast<char>((i * 7 + i / 13) % 97));
+    }
+    // A few rare symbols get codes long enough for the second-level and fallback tables
+    message[500] = static_cast<char>(200);
+    message[90000] = static_cast<char>(201);
+
+    // Block sizes that leave some sub-streams short or empty
+    for (size_t blockSize : {1u, 3u, 5u, 4096u, 100003u}) {
+        Huffman encoder;
+        encoder.setBlockSize(blockSize);
+        encoder.setInterleaved(true);
+        encoder.buildTree(Histogram::count(message));
+        std::vector<uint8_t> compressedMessage = encoder.compress(message);
+        std::vector<CodedBlock> blocks = encoder.getBlocks();
+        std::vector<uint8_t> codeLengths = encoder.getCodeLengths();
+
+        Huffman single;
+        single.setBlockSize(blockSize);
+        single.buildTree(Histogram::count(message));
+        size_t singleSize = single.compress(message).size();
+        size_t numBlocks = (message.size() + blockSize - 1) / blockSize;
+        EXPECT_LE(compressedMessage.size(), singleSize + numBlocks * 12 + 1);
+
+        Huffman decoder;
+        decoder.setInterleaved(true);
+        EXPECT_EQ(decoder.uncompress(compressedMessage, message.size(), &codeLengths, &blocks), message) << blockSize;
+    }
+
+    // Interleaving combines with per-block tables and raw blocks
+    Huffman adaptive;
+    adaptive.setBlockSize(4096);
+    adaptive.setAdaptive(true);
+    adaptive.setInterleaved(true);
+    adaptive.buildTree(Histogram::count(std::vector<char>(message.begin(), message.begin() + 100)));
+    std::vector<uint8_t> compressedMessage = adaptive.compress(message);
+    std::vector<CodedBlock> blocks = adaptive.getBlocks();
+    std::vector<uint8_t> codeLengths = adaptive.getCodeLengths();
+    Huffman decoder;
+    decoder.setInterleaved(true);
+    EXPECT_EQ(decoder.uncompress(compressedMessage, message.size(), &codeLengths, &blocks), message);
+
+    // An empty input has no blocks and no jump table
+    Huffman empty;
+    empty.setInterleaved(true);
+    empty.buildTree(Histogram::count(message));
+    std::vector<uint8_t> compressedEmpty = empty.compress(std::vector<char>());
+    std::vector<CodedBlock> emptyBlocks = empty.getBlocks();
+    EXPECT_TRUE(empty.uncompress(compressedEmpty, 0, &codeLengths, &emptyBlocks).empty());
+    testing::internal::CaptureStderr();
+    EXPECT_TRUE(empty.uncompress(std::vector<uint8_t>(), 0).empty());
+    EXPECT_EQ(testing::internal::GetCapturedStderr(), "");
+}
+
+TEST(HuffmanTest, OrderOneContexts) {
+    // Every byte is almost determined by the one before it, which order-0 coding can not see
+    std::vector<char> message;
+    uint32_t state = 12345;
+    char previous = 'a';
+    for (int i = 0; i < 400000; i++) {
+        state = state * 1103515245 + 12345;
+        char next = (state >> 16) % 16 ? static_cast<char>('a' + (previous - 'a' + 7) % 26) : static_cast<char>('a' + (state >> 8) % 26);
+        message.push_back(next);
+        previous = next;
+    }
+    // A handful of bytes that only appear once: their contexts are too sparse for a table
+    message[1000] = '!';
+    message[200000] = '?';
+
+    Huffman orderZero;
+    orderZero.fitModel(message);
+    size_t orderZeroSize = orderZero.compress(message).size();
+
+    ContextHuffman encoder;
+    encoder.setBlockSize(50000);
+    encoder.fitModel(message);
+    std::vector<uint8_t> compressedMessage = encoder.compress(message);
+    std::vector<uint8_t> table = encoder.getTable();
+    std::vector<CodedBlock> blocks = encoder.getBlocks();
+
+    // 26 letter contexts keep their own table, the sparse ones share the fallback
+    EXPECT_EQ(encoder.getTableCount(), 27u);
+    EXPECT_LT(compressedMessage.size() + table.size(), orderZeroSize / 2);
+
+    ContextHuffman decoder;
+    EXPECT_EQ(decoder.uncompress(compressedMessage, message.size(), &table, &blocks), message);
+
+    // A context pointing past the last table is rejected
+    table[0] = static_cast<uint8_t>(encoder.getTableCount());
+    EXPECT_THROW(decoder.setTable(table), std::invalid_argument);
+}
+
+TEST(HuffmanTest, OrderOneFallsBackToOneTable) {
+    // Without any structure between neighbours no context pays for its own table
+    std::vector<char> message;
+    uint32_t state = 54321;
+    for (int i = 0; i < 20000; i++) {
+        state = state * 1103515245 + 12345;
+        message.push_back(static_cast<char>((state >> 16) % 64));
+    }
+
+    ContextHuffman coder;
+    coder.fitModel(message);
+    std::vector<uint8_t> compressedMessage = coder.compress(message);
+    EXPECT_EQ(coder.getTableCount(), 1u);
+    EXPECT_EQ(coder.uncompress(compressedMessage, message.size()), message);
+}
+
+
+TEST(HuffmanTest, StreamingRoundTripInBoundedChunks) {
+    // Skewed, random and constant stretches exercise new tables, reused tables and raw blocks
+    std::vector<char> message;
+    uint32_t state = 7;
+    for (int i = 0; i < 600000; i++) {
+        state = state * 1103515245 + 12345;
+        unsigned value = (state >> 16) & 0xFFFF;
+        if (i < 250000) message.push_back(static_cast<char>(__builtin_clz(value | 1) + 'a'));
+        else if (i < 400000) message.push_back(static_cast<char>(value));
+        else message.push_back(i < 450000 ? 'x' : static_cast<char>(__builtin_clz(value | 1) + 'a'));
+    }
+
+    const size_t blockSize = 1 << 14;
+    std::stringstream stream;
+    HuffmanStreamEncoder encoder(blockSize, 12);
+    encoder.begin(stream);
+    size_t pushed = 0;
+    for (size_t chunk : {1u, 7777u, 100000u}) {
+        while (pushed < message.size()) {
+            size_t size = std::min<size_t>(chunk, message.size() - pushed);
+            encoder.push(message.data() + pushed, size);
+            pushed += size;
+            if (chunk == 1 && pushed >= 1000) break;
+            if (chunk == 7777 && pushed >= 300000) break;
+        }
+    }
+    uint64_t written = encoder.finish();
+    EXPECT_EQ(written, stream.str().size());
+    EXPECT_LT(written, message.size() * 3 / 4);
+
+    HuffmanStreamDecoder decoder;
+    decoder.begin(stream);
+    std::vector<char> decoded, chunk;
+    while (decoder.pull(chunk)) {
+        EXPECT_LE(chunk.size(), blockSize * omp_get_max_threads());
+        decoded.insert(decoded.end(), chunk.begin(), chunk.end());
+    }
+    EXPECT_EQ(decoded, message);
+    EXPECT_FALSE(decoder.pull(chunk));
+}
+
+TEST(HuffmanTest, StreamingEdgeCasesAndCorruption) {
+    std::stringstream empty;
+    HuffmanStreamEncoder encoder;
+    encoder.begin(empty);
+    encoder.finish();
+    HuffmanStreamDecoder decoder;
+    decoder.begin(empty);
+    std::vector<char> chunk;
+    EXPECT_FALSE(decoder.pull(chunk));
+    EXPECT_TRUE(chunk.empty());
+
+    EXPECT_THROW(HuffmanStreamEncoder(0), std::invalid_argument);
+    EXPECT_THROW(HuffmanStreamEncoder(1 << 10, 57), std::invalid_argument);
+    EXPECT_THROW(encoder.push(std::vector<char>{'a'}), std::invalid_argument);
+
+    std::vector<char> message(50000);
+    for (size_t i = 0; i < message.size(); i++) message[i] = "aaaabbc"[i % 7];
+    std::stringstream stream;
+    encoder.begin(stream);
+    encoder.push(message);
+    encoder.finish();
+    std::string coded = stream.str();
+
+    std::stringstream truncated(coded.substr(0, coded.size() - 10));
+    decoder.begin(truncated);
+    EXPECT_THROW(while (decoder.pull(chunk)) {}, std::invalid_argument);
+
+    std::string badMode = coded;
+    badMode[8] = 7;  // Mode byte of the first block
+    std::stringstream badModeStream(badMode);
+    decoder.begin(badModeStream);
+    EXPECT_THROW(decoder.pull(chunk), std::invalid_argument);
+}
 
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
-}
\ No newline at end of file
+}
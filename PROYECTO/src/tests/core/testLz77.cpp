@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include "../../core/Lz77.h"
+#include <stdexcept>
+
+TEST(Lz77Test, RepetitiveInputShrinks) {
+    std::vector<char> message;
+    std::string line = "int main(int argc, char *argv[]) { return 0; }\n";
+    for (int i = 0; i < 20000; i++) {
+        message.insert(message.end(), line.begin(), line.end());
+        message.push_back(static_cast<char>('a' + i % 26));
+    }
+
+    Lz77 lz77;
+    std::vector<char> compressedMessage = lz77.compress(message);
+    EXPECT_LT(compressedMessage.size() * 10, message.size());
+    EXPECT_EQ(Lz77::uncompress(compressedMessage), message);
+}
+
+TEST(Lz77Test, RandomInputAndSmallWindow) {
+    // Incompressible data with a copy farther back than the window, across several chunks
+    std::vector<char> message;
+    uint32_t state = 12345;
+    for (int i = 0; i < 5000000; i++) {
+        state = state * 1103515245 + 12345;
+        message.push_back(static_cast<char>(state >> 16));
+    }
+    message.insert(message.end(), message.begin(), message.begin() + 100000);
+
+    Lz77 lz77;
+    lz77.setWindowSize(1 << 16);
+    lz77.setSearchDepth(4);
+    std::vector<char> compressedMessage = lz77.compress(message);
+    EXPECT_GT(compressedMessage.size(), message.size());
+    EXPECT_EQ(Lz77::uncompress(compressedMessage), message);
+
+    lz77.setWindowSize(1 << 23);
+    lz77.setSearchDepth(256);
+    std::vector<char> fullWindow = lz77.compress(message);
+    EXPECT_LT(fullWindow.size() + 90000, compressedMessage.size());
+    EXPECT_EQ(Lz77::uncompress(fullWindow), message);
+}
+
+TEST(Lz77Test, OverlappingMatchesAndTinyInputs) {
+    std::vector<char> run(100000, 'x');
+    run.push_back('y');
+    std::vector<char> pattern;
+    for (int i = 0; i < 1000; i++) {
+        pattern.push_back("abc"[i % 3]);
+    }
+
+    Lz77 lz77;
+    for (const std::vector<char> &message : {run, pattern, std::vector<char>(), std::vector<char>{'q'}, std::vector<char>(5, 'q')}) {
+        EXPECT_EQ(Lz77::uncompress(lz77.compress(message)), message);
+    }
+    EXPECT_LT(lz77.compress(run).size(), 1000u);
+}
+
+TEST(Lz77Test, InvalidStreamsAndSettings) {
+    Lz77 lz77;
+    EXPECT_THROW(lz77.setWindowSize(3000), std::invalid_argument);
+    EXPECT_THROW(lz77.setWindowSize(1 << 25), std::invalid_argument);
+    EXPECT_THROW(lz77.setSearchDepth(0), std::invalid_argument);
+
+    std::vector<char> message(5000, 'x');
+    std::vector<char> compressedMessage = lz77.compress(message);
+    std::vector<char> truncated(compressedMessage.begin(), compressedMessage.end() - 1);
+    EXPECT_THROW(Lz77::uncompress(truncated), std::invalid_argument);
+    std::vector<char> farDistance = compressedMessage;
+    farDistance[18] = static_cast<char>(0xFF);  // Distance of the first match beyond the output
+    EXPECT_THROW(Lz77::uncompress(farDistance), std::invalid_argument);
+    EXPECT_THROW(Lz77::uncompress(std::vector<char>(4, 0)), std::invalid_argument);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "../../helpers/ModArith.h"
+#include "../../helpers/Utils.h"
+#include <chrono>
+
+static uint64_t referencePower(uint64_t base, uint64_t exponent, uint64_t modulus) {
+    // Square-and-multiply with a 128-bit divide per step, the straightforward way
+    uint128_t result = 1 % modulus, square = base % modulus;
+    while (exponent > 0) {
+        if (exponent & 1) result = result * square % modulus;
+        square = square * square % modulus;
+        exponent >>= 1;
+    }
+    return static_cast<uint64_t>(result);
+}
+
+static int divisionPowerModulus(int base, int expo, int m) {
+    // The previous Utils::powerModulus, kept as the baseline of the microbenchmark
+    int result = 1;
+    base = base % m;
+    while (expo > 0) {
+        if (expo & 1) result = (result * 1LL * base) % m;
+        base = (base * 1LL * base) % m;
+        expo = expo / 2;
+    }
+    return result;
+}
+
+TEST(ModArithTest, MatchesDivisionOnSmallAndFullWidthModuli) {
+    uint64_t state = 88172645463325252ull;
+    auto next = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    std::vector<uint64_t> moduli = {2, 3, 4, 255, 256, 7990271, (1ull << 31) - 1, (1ull << 32) + 15,
+                                    (1ull << 63) - 25, (1ull << 63) + 1, ~0ull, ~0ull - 1};
+    for (int i = 0; i < 200; i++) moduli.push_back(next() >> (next() % 63));
+    for (uint64_t modulus : moduli) {
+        if (modulus < 2) continue;
+        for (int i = 0; i < 20; i++) {
+            uint64_t base = next(), exponent = next() >> (next() % 64);
+            uint64_t expected = referencePower(base, exponent, modulus);
+            EXPECT_EQ(Barrett64(modulus).power(base, exponent), expected) << modulus;
+            EXPECT_EQ(ModArith::power(base, exponent, modulus), expected) << modulus;
+            if (modulus & 1) {
+                EXPECT_EQ(Montgomery64(modulus).power(base, exponent), expected) << modulus;
+            }
+        }
+        EXPECT_EQ(ModArith::power(modulus - 1, 2, modulus), 1u % modulus);
+        EXPECT_EQ(ModArith::power(12345, 0, modulus), 1u);
+    }
+    EXPECT_EQ(ModArith::power(5, 3, 1), 0u);
+    EXPECT_THROW(Montgomery64(10), std::invalid_argument);
+    EXPECT_THROW(Barrett64(0), std::invalid_argument);
+
+    for (int base = -5; base < 300; base += 7) {
+        int expected = static_cast<int>(referencePower(((base % 7990271) + 7990271) % 7990271, 65537, 7990271));
+        EXPECT_EQ(Utils::powerModulus(base, 65537, 7990271), expected);
+    }
+}
+
+TEST(ModArithTest, Microbenchmark) {
+    // Exponentiation throughput against the divide-per-step version, for a key-sized modulus
+    // (31 bits, what the current keys use) and a full 64-bit one. Timings are informative only.
+    const int iterations = 200000;
+    const int n31 = 7990271, d31 = 5328133;
+    const uint64_t n64 = (1ull << 63) - 25, d64 = 0x5DEECE66Dull;
+    uint64_t sink = 0;
+
+    auto time = [&](const char *name, auto &&body) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++) sink += body(i);
+        auto end = std::chrono::high_resolution_clock::now();
+        printf("\033[1;32m🟢 [Timing] %s: %.1f ns per exponentiation\033[0m\n", name,
+               std::chrono::duration<double, std::nano>(end - start).count() / iterations);
+    };
+    Montgomery64 montgomery31(n31), montgomery64(n64);
+    Barrett64 barrett31(n31), barrett64(n64);
+    time("31-bit division", [&](int i) { return static_cast<uint64_t>(divisionPowerModulus(i % n31, d31, n31)); });
+    time("31-bit Montgomery", [&](int i) { return montgomery31.power(i, d31); });
+    time("31-bit Barrett", [&](int i) { return barrett31.power(i, d31); });
+    time("64-bit division", [&](int i) { return referencePower(i, d64, n64); });
+    time("64-bit Montgomery", [&](int i) { return montgomery64.power(i, d64); });
+    time("64-bit Barrett", [&](int i) { return barrett64.power(i, d64); });
+    EXPECT_NE(sink, 0u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
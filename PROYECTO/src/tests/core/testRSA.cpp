@@ -23,27 +23,132 @@ TEST(RSATest, GenerateKeys) {
     std::cout << "Private Key: " << keys.privateKey << std::endl;
 
     EXPECT_EQ(publicKeyValues.size(), 2);
-    EXPECT_EQ(privateKeyValues.size(), 2);
+    EXPECT_EQ(privateKeyValues.size(), 7);
 }
 
 TEST(RSATest, EncryptAndDecrypt) {
     Rsa rsa(7919, 1009);
     ResultGenerateKeys keys = rsa.generateKeys();
 
-    std::vector<char> vec = FileManager::readTextFile(TEMPLATE_PATH);
-    std::string str(vec.data());
-    const char* message = str.c_str();
+    std::vector<uint8_t> message = FileManager::readBinaryFile(TEMPLATE_PATH);
 
-    char* encryptedMessage = rsa.encrypt(message, keys.publicKey);
-    char* decryptedMessage = rsa.decrypt(encryptedMessage, keys.privateKey);
+    std::vector<uint8_t> encryptedMessage = rsa.encrypt(message, keys.publicKey);
+    std::vector<uint8_t> decryptedMessage = rsa.decrypt(encryptedMessage, keys.privateKey);
 
-    std::cout << "Encrypted Message: " << encryptedMessage << std::endl;
-    std::cout << "Decrypted Message: " << decryptedMessage << std::endl;
+    EXPECT_EQ(encryptedMessage.size(), message.size() * 4);
+    EXPECT_EQ(message, decryptedMessage);
+}
+
+TEST(RSATest, SubstitutionTableMatchesExponentiation) {
+    Rsa rsa(7919, 1009);
+    ResultGenerateKeys keys = rsa.generateKeys();
+    vector<int> publicKeyValues = Utils::base64ToNumbers(keys.publicKey);
+
+    // Every byte value, then a long message that repeats them in both directions
+    std::vector<uint8_t> alphabet(256);
+    for (int byte = 0; byte < 256; byte++) {
+        alphabet[byte] = static_cast<uint8_t>(byte);
+    }
+    std::vector<uint8_t> encryptedAlphabet = rsa.encrypt(alphabet, keys.publicKey);
+    for (int byte = 0; byte < 256; byte++) {
+        int word = (encryptedAlphabet[byte * 4] << 24) | (encryptedAlphabet[byte * 4 + 1] << 16) |
+                   (encryptedAlphabet[byte * 4 + 2] << 8) | encryptedAlphabet[byte * 4 + 3];
+        EXPECT_EQ(word, Utils::powerModulus(byte, publicKeyValues[0], publicKeyValues[1])) << byte;
+    }
+
+    std::vector<uint8_t> message;
+    for (int i = 0; i < 1000000; i++) {
+        message.push_back(static_cast<uint8_t>(i * 31 + i / 257));
+    }
+    EXPECT_EQ(rsa.decrypt(rsa.encrypt(message, keys.publicKey), keys.privateKey), message);
+}
+
+TEST(RSATest, CrtDecryptionMatchesPlainExponentiation) {
+    Rsa rsa(7919, 1009);
+    ResultGenerateKeys keys = rsa.generateKeys();
+    vector<int> privateKeyValues = Utils::base64ToNumbers(keys.privateKey);
+    ASSERT_EQ(privateKeyValues.size(), 7);
+    EXPECT_EQ(privateKeyValues[2] * privateKeyValues[3], privateKeyValues[1]);
+
+    std::vector<uint8_t> message;
+    for (int i = 0; i < 100000; i++) {
+        message.push_back(static_cast<uint8_t>(i * 7 + i / 131));
+    }
+    std::vector<uint8_t> encryptedMessage = rsa.encrypt(message, keys.publicKey);
+    // A private key of only {d, n} takes the direct path and must agree with the CRT one
+    char *plainKey = Utils::numbersToBase64({privateKeyValues[0], privateKeyValues[1]});
+    EXPECT_EQ(rsa.decrypt(encryptedMessage, plainKey), message);
+    EXPECT_EQ(rsa.decrypt(encryptedMessage, keys.privateKey), message);
+    Utils::freeCString(plainKey);
+
+    privateKeyValues[2] += 2;  // p * q no longer matches n
+    char *brokenKey = Utils::numbersToBase64(privateKeyValues);
+    EXPECT_THROW(rsa.decrypt(encryptedMessage, brokenKey), std::invalid_argument);
+    Utils::freeCString(brokenKey);
+
+    // The prime 2 would make dP or dQ zero, so CRT could not recover even residues
+    EXPECT_THROW(Rsa(2, 131).generateKeys(), std::invalid_argument);
+    EXPECT_THROW(Rsa(131, 2).generateKeys(), std::invalid_argument);
+}
+
+TEST(RSATest, PackedCiphertextRoundTrips) {
+    Rsa rsa(7919, 1009);
+    ResultGenerateKeys keys = rsa.generateKeys();
+    unsigned bits = Rsa::cipherBits(keys.publicKey);
+    EXPECT_EQ(bits, 23u);  // 7919 * 1009 = 7990271 < 2^23
+
+    for (size_t size : {size_t(0), size_t(1), size_t(7), size_t(8), size_t(8193), size_t(100003)}) {
+        std::vector<uint8_t> message(size);
+        for (size_t i = 0; i < size; i++) {
+            message[i] = static_cast<uint8_t>(i * 13 + i / 251);
+        }
+        std::vector<uint8_t> words = rsa.encrypt(message, keys.publicKey);
+        std::vector<uint8_t> packed = rsa.encrypt(message, keys.publicKey, bits);
+        EXPECT_EQ(packed.size(), (size * bits + 7) / 8);
+        EXPECT_EQ(rsa.decrypt(packed, keys.privateKey, bits), message);
+
+        // The first value sits MSB-first in the first 23 bits
+        if (size > 0) {
+            uint32_t first = (packed[0] << 15) | (packed[1] << 7) | (packed[2] >> 1);
+            uint32_t word = (words[0] << 24) | (words[1] << 16) | (words[2] << 8) | words[3];
+            EXPECT_EQ(first, word);
+        }
+    }
+    // Wider packing than needed still round-trips, narrower can not hold the values
+    std::vector<uint8_t> message(1000, 'x');
+    EXPECT_EQ(rsa.decrypt(rsa.encrypt(message, keys.publicKey, 32), keys.privateKey, 32), message);
+    EXPECT_THROW(rsa.encrypt(message, keys.publicKey, bits - 1), std::invalid_argument);
+    EXPECT_THROW(rsa.decrypt(message, keys.privateKey, 33), std::invalid_argument);
+}
+
+TEST(RSATest, RandomPrimesUseTheStandardExponent) {
+    int p = Utils::randomPrime(15), q;
+    do {
+        q = Utils::randomPrime(15);
+    } while (q == p);
+    Rsa rsa(p, q);
+    ResultGenerateKeys keys = rsa.generateKeys();
+    vector<int> publicKeyValues = Utils::base64ToNumbers(keys.publicKey);
+    vector<int> privateKeyValues = Utils::base64ToNumbers(keys.privateKey);
+    long long phi = static_cast<long long>(p - 1) * (q - 1);
+    EXPECT_EQ(publicKeyValues[1], p * q);
+    if (std::__gcd(65537LL, phi) == 1) {
+        EXPECT_EQ(publicKeyValues[0], Rsa::PUBLIC_EXPONENT);
+    }
+    EXPECT_EQ(static_cast<long long>(publicKeyValues[0]) * privateKeyValues[0] % phi, 1);
 
-    EXPECT_STREQ(message, decryptedMessage);
+    std::vector<uint8_t> message(5000);
+    for (size_t i = 0; i < message.size(); i++) {
+        message[i] = static_cast<uint8_t>(i * 37);
+    }
+    EXPECT_EQ(rsa.decrypt(rsa.encrypt(message, keys.publicKey), keys.privateKey), message);
 
-    Utils::freeCString(encryptedMessage);
-    Utils::freeCString(decryptedMessage);
+    // 65537 is not below phi(n) = 40 here, so a random odd exponent is chosen
+    Rsa small(11, 5);
+    ResultGenerateKeys smallKeys = small.generateKeys();
+    vector<int> smallValues = Utils::base64ToNumbers(smallKeys.publicKey);
+    EXPECT_LT(smallValues[0], 40);
+    EXPECT_EQ(std::__gcd(smallValues[0], 40), 1);
 }
 
 int main(int argc, char **argv) {
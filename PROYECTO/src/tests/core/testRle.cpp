@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include "../../core/Rle.h"
+#include <stdexcept>
+
+TEST(RleTest, LongRunsCollapse) {
+    // Zero padding with a few bytes in between, as in sparse files
+    std::vector<char> message(1000000, 0);
+    for (int i = 0; i < 1000000; i += 65536) {
+        message[i] = static_cast<char>(i / 65536 + 1);
+    }
+
+    Rle rle;
+    EXPECT_TRUE(rle.worthwhile(message));
+    std::vector<char> compressedMessage = rle.compress(message);
+    EXPECT_LT(compressedMessage.size(), 200u);
+    EXPECT_EQ(Rle::uncompress(compressedMessage), message);
+}
+
+TEST(RleTest, WordUnitsAndEscapes) {
+    // Runs of a repeated 4-byte word, every byte value (the escape included) and a partial last word
+    std::vector<char> message;
+    for (int i = 0; i < 300000; i++) {
+        message.push_back(static_cast<char>(i % 256));
+        if (i % 1000 == 0) {
+            for (int j = 0; j < 40; j++) {
+                message.insert(message.end(), {0x12, 0x34, 0x56, 0x78});
+            }
+        }
+    }
+    message.push_back('!');
+    message.push_back('?');
+
+    Rle bytes(1), words(4);
+    for (const Rle *rle : {&bytes, &words}) {
+        EXPECT_EQ(Rle::uncompress(rle->compress(message)), message);
+    }
+    EXPECT_LT(words.compress(message).size(), message.size());
+    EXPECT_GT(bytes.compress(message).size(), message.size());
+}
+
+TEST(RleTest, WorthwhileOnlyWithRuns) {
+    std::vector<char> message;
+    uint32_t state = 12345;
+    for (int i = 0; i < 2000000; i++) {
+        state = state * 1103515245 + 12345;
+        message.push_back(static_cast<char>(state >> 16));
+    }
+
+    Rle rle;
+    EXPECT_FALSE(rle.worthwhile(message));
+    EXPECT_EQ(Rle::uncompress(rle.compress(message)), message);
+    EXPECT_EQ(Rle::uncompress(rle.compress(std::vector<char>())), std::vector<char>());
+    EXPECT_EQ(Rle::uncompress(rle.compress(std::vector<char>{'a'})), std::vector<char>{'a'});
+}
+
+TEST(RleTest, InvalidStreamsAndSettings) {
+    EXPECT_THROW(Rle(0), std::invalid_argument);
+    EXPECT_THROW(Rle(9), std::invalid_argument);
+
+    Rle rle;
+    std::vector<char> compressedMessage = rle.compress(std::vector<char>(5000, 'x'));
+    std::vector<char> truncated(compressedMessage.begin(), compressedMessage.end() - 1);
+    EXPECT_THROW(Rle::uncompress(truncated), std::invalid_argument);
+    std::vector<char> longer = compressedMessage;
+    longer.push_back('x');
+    EXPECT_THROW(Rle::uncompress(longer), std::invalid_argument);
+    EXPECT_THROW(Rle::uncompress(std::vector<char>(4, 0)), std::invalid_argument);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "../../core/Tans.h"
+#include "../../core/Huffman.h"
+#include <memory>
+
+TEST(TansTest, CompressAndUncompressWithTableOnly) {
+    std::vector<char> message;
+    for (int i = 0; i < 300007; i++) {
+        message.push_back(static_cast<char>((i * i + i / 7) % 251));
+    }
+
+    Tans encoder;
+    encoder.setBlockSize(65536);
+    encoder.buildModel(Histogram::count(message));
+    std::vector<uint8_t> compressedMessage = encoder.compress(message);
+    std::vector<uint8_t> table = encoder.getTable();
+    std::vector<CodedBlock> blocks = encoder.getBlocks();
+    ASSERT_EQ(blocks.size(), 5u);
+    EXPECT_EQ(blocks[1].outputOffset, 65536u);
+    EXPECT_EQ(blocks[1].bitOffset % 8, 0u);
+
+    Tans decoder;
+    EXPECT_LT(compressedMessage.size(), message.size());
+    EXPECT_EQ(decoder.uncompress(compressedMessage, message.size(), &table, &blocks), message);
+}
+
+TEST(TansTest, SingleSymbol) {
+    std::vector<char> message(1000, 'z');
+
+    Tans tans;
+    tans.buildModel(Histogram::count(message));
+    std::vector<uint8_t> compressedMessage = tans.compress(message);
+
+    // Only the initial state is stored: the only symbol costs no bits at all
+    EXPECT_EQ(compressedMessage.size(), 2u);
+    EXPECT_EQ(tans.uncompress(compressedMessage, message.size()), message);
+}
+
+TEST(TansTest, SkewedInputBeatsHuffman) {
+    // 95% of one byte: Huffman needs at least 1 bit per symbol, tANS gets close to the entropy
+    std::vector<char> message;
+    uint32_t state = 12345;
+    for (int i = 0; i < 200000; i++) {
+        state = state * 1103515245 + 12345;
+        message.push_back((state >> 16) % 100 < 95 ? 'a' : static_cast<char>('b' + (state >> 8) % 4));
+    }
+
+    std::vector<std::unique_ptr<EntropyCoder>> coders;
+    coders.push_back(std::make_unique<Huffman>());
+    coders.push_back(std::make_unique<Tans>());
+    std::vector<size_t> sizes;
+    for (std::unique_ptr<EntropyCoder> &coder : coders) {
+        coder->buildModel(Histogram::count(message));
+        std::vector<uint8_t> compressedMessage = coder->compress(message);
+        EXPECT_EQ(coder->uncompress(compressedMessage, message.size()), message) << coder->getName();
+        sizes.push_back(compressedMessage.size());
+    }
+    EXPECT_GE(sizes[0], message.size() / 8);
+    EXPECT_LT(sizes[1] * 2, sizes[0]);
+}
+
+TEST(TansTest, TableLogs) {
+    std::vector<char> message;
+    for (int i = 0; i < 50000; i++) {
+        message.push_back(static_cast<char>((i * 7 + i / 13) % 29));
+    }
+    message[100] = static_cast<char>(200);
+
+    for (unsigned log : {5u, 9u, 15u}) {
+        Tans encoder;
+        encoder.setTableLog(log);
+        encoder.setBlockSize(4099);
+        encoder.buildModel(Histogram::count(message));
+        std::vector<uint8_t> compressedMessage = encoder.compress(message);
+        std::vector<uint8_t> table = encoder.getTable();
+        std::vector<CodedBlock> blocks = encoder.getBlocks();
+
+        Tans decoder;
+        EXPECT_EQ(decoder.uncompress(compressedMessage, message.size(), &table, &blocks), message) << log;
+    }
+
+    Tans tans;
+    EXPECT_THROW(tans.setTableLog(4), std::invalid_argument);
+    EXPECT_THROW(tans.setTableLog(16), std::invalid_argument);
+}
+
+TEST(TansTest, InvalidTablesAndSymbols) {
+    Tans tans;
+    EXPECT_THROW(tans.setTable(std::vector<uint8_t>(10, 0)), std::invalid_argument);
+
+    // Normalized counts must add up to the table size
+    std::vector<uint8_t> table(1 + 256 * 2, 0);
+    table[0] = 5;
+    table[1 + 2 * 'a' + 1] = 20;
+    EXPECT_THROW(tans.setTable(table), std::invalid_argument);
+    table[1 + 2 * 'b' + 1] = 12;
+    EXPECT_NO_THROW(tans.setTable(table));
+
+    std::vector<char> message = {'a', 'b', 'c'};
+    EXPECT_THROW(tans.compress(message), std::invalid_argument);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "../../helpers/Utils.h"
+#include "../../helpers/Histogram.h"
 
 using std::vector;
 using std::string;
@@ -44,6 +45,60 @@ TEST(UtilsTest, ModInverse) {
     EXPECT_EQ(Utils::modInverse(5, 12), 5);
     EXPECT_EQ(Utils::modInverse(7, 40), 23);
     EXPECT_EQ(Utils::modInverse(5, 12), 5);
+    // Extended Euclid handles key-sized moduli and reports missing inverses
+    EXPECT_EQ(Utils::modInverse(65537, 7981344), 6650369);
+    EXPECT_EQ(65537LL * 6650369 % 7981344, 1);
+    EXPECT_EQ(Utils::modInverse(6, 12), -1);
+    EXPECT_EQ(Utils::modInverse(1, 12), 1);
+}
+
+TEST(UtilsTest, PrimesMatchTrialDivision) {
+    for (int n = -3; n < 20000; n++) {
+        bool prime = n > 1;
+        for (int divisor = 2; prime && divisor * divisor <= n; divisor++) {
+            prime = n % divisor != 0;
+        }
+        EXPECT_EQ(Utils::isPrime(n), prime) << n;
+    }
+    EXPECT_TRUE(Utils::isPrime(2147483647));      // 2^31 - 1
+    EXPECT_FALSE(Utils::isPrime(3215031751LL));   // Strong pseudoprime to the bases 2, 3, 5 and 7
+    EXPECT_TRUE(Utils::isPrime(1000000000000000003LL));
+
+    for (unsigned bits : {3u, 8u, 15u, 30u}) {
+        int prime = Utils::randomPrime(bits);
+        EXPECT_TRUE(Utils::isPrime(prime));
+        EXPECT_GE(prime, 1 << (bits - 1));
+        EXPECT_LT(prime, 1LL << bits);
+    }
+    EXPECT_THROW(Utils::randomPrime(31), std::invalid_argument);
+}
+
+TEST(HistogramTest, CountsEveryByteValue) {
+    vector<uint8_t> data;
+    for (int i = 0; i < 300007; i++) {
+        data.push_back(static_cast<uint8_t>((i * 31 + i / 1000) & 0xFF));
+    }
+    FrequencyTable expected{};
+    for (uint8_t byte : data) {
+        expected[byte]++;
+    }
+
+    EXPECT_EQ(Histogram::count(data), expected);
+    EXPECT_EQ(Histogram::count(data.data(), data.size(), false), expected);
+
+    vector<char> chars(data.begin(), data.end());
+    EXPECT_EQ(Histogram::count(chars), expected);
+}
+
+TEST(HistogramTest, LongRunsAndEmptyInput) {
+    vector<uint8_t> data(100003, 0xAB);
+    FrequencyTable frequencies = Histogram::count(data);
+    EXPECT_EQ(frequencies[0xAB], data.size());
+
+    FrequencyTable empty = Histogram::count(vector<uint8_t>());
+    for (uint64_t count : empty) {
+        EXPECT_EQ(count, 0);
+    }
 }
 
 int main(int argc, char **argv) {
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "../../core/WordMap.h"
+#include "../../core/RSA.h"
+
+TEST(WordMapTest, CiphertextWordsBecomeOneByteEach) {
+    std::vector<uint8_t> message;
+    for (int i = 0; i < 100000; i++) {
+        message.push_back(static_cast<uint8_t>(i * 7 + i / 13));
+    }
+    Rsa rsa(7919, 1009);
+    ResultGenerateKeys keys = rsa.generateKeys();
+    std::vector<uint8_t> encryptedMessage = rsa.encrypt(message, keys.publicKey);
+    std::vector<char> ciphertext(encryptedMessage.begin(), encryptedMessage.end());
+
+    std::vector<char> mapped = WordMap::compress(ciphertext);
+    // Header and 256 dictionary words, then one index per plaintext byte
+    EXPECT_EQ(mapped.size(), 2 + 256 * 4 + message.size());
+    EXPECT_EQ(WordMap::uncompress(mapped), ciphertext);
+}
+
+TEST(WordMapTest, OnlyFitsFewWholeWords) {
+    std::vector<char> fewWords;
+    for (int i = 0; i < 4000; i++) {
+        fewWords.insert(fewWords.end(), {0, 0, static_cast<char>(i % 3), 1});
+    }
+    std::vector<char> mapped = WordMap::compress(fewWords);
+    EXPECT_EQ(mapped.size(), 2 + 3 * 4 + 1000u * 4);
+    EXPECT_EQ(WordMap::uncompress(mapped), fewWords);
+    EXPECT_EQ(WordMap::uncompress(WordMap::compress(std::vector<char>())), std::vector<char>());
+
+    std::vector<char> partialWord(fewWords.begin(), fewWords.end() - 1);
+    EXPECT_TRUE(WordMap::compress(partialWord).empty());
+    std::vector<char> manyWords;
+    for (int i = 0; i < 300; i++) {
+        manyWords.insert(manyWords.end(), {0, 0, static_cast<char>(i >> 8), static_cast<char>(i)});
+    }
+    EXPECT_TRUE(WordMap::compress(manyWords).empty());
+
+    mapped.push_back(3);  // Index beyond the dictionary
+    EXPECT_THROW(WordMap::uncompress(mapped), std::invalid_argument);
+    EXPECT_THROW(WordMap::uncompress(std::vector<char>{1, 0, 0}), std::invalid_argument);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}